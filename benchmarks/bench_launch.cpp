@@ -0,0 +1,180 @@
+#include <childreaper.h>
+#include <processcfg.h>
+#include <processlauncher.h>
+#include <fmt/format.h>
+#include <boost/asio.hpp>
+#include <boost/process.hpp>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The launch path as it was before the coroutines: a Process object kept alive by the shared_from_this callbacks
+// of its pipe reads and child reaping, delivering the result to a std::function handler.
+class CallbackLaunch : public std::enable_shared_from_this<CallbackLaunch> {
+public:
+    CallbackLaunch(boost::asio::io_context& io, std::function<void(const stone_skipper::ProcessResult&)> resultHandler)
+        : resultHandler_{std::move(resultHandler)}
+        , childReaper_{boost::asio::use_service<stone_skipper::ChildReaper>(io)}
+        , stdOutPipe_{io}
+        , stdErrPipe_{io}
+    {
+    }
+
+    void launch(const boost::filesystem::path& cmd, const std::vector<std::string>& args)
+    {
+        auto child = boost::process::child{
+                cmd,
+                boost::process::args(args),
+                boost::process::std_out > stdOutPipe_,
+                boost::process::std_err > stdErrPipe_};
+        const auto pid = child.id();
+        child.detach();
+        childReaper_.watch(
+                pid,
+                [self = shared_from_this()](int status, const stone_skipper::ResourceUsage& resourceUsage)
+                {
+                    self->result_.exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : status;
+                    self->result_.resourceUsage = resourceUsage;
+                    self->onOperationFinished();
+                });
+        readOutput(stdOutPipe_, stdOutBuffer_, result_.output);
+        readOutput(stdErrPipe_, stdErrBuffer_, result_.errorOutput);
+    }
+
+private:
+    void readOutput(boost::process::async_pipe& pipe, std::array<char, 4096>& buffer, std::string& output)
+    {
+        pipe.async_read_some(
+                boost::asio::buffer(buffer),
+                [self = shared_from_this(), &pipe, &buffer, &output](
+                        const boost::system::error_code& ec,
+                        std::size_t bytesTransferred)
+                {
+                    output.append(buffer.data(), bytesTransferred);
+                    if (ec) {
+                        self->onOperationFinished();
+                        return;
+                    }
+                    self->readOutput(pipe, buffer, output);
+                });
+    }
+
+    void onOperationFinished()
+    {
+        if (--pendingOperationsNumber_ == 0)
+            resultHandler_(result_);
+    }
+
+private:
+    std::function<void(const stone_skipper::ProcessResult&)> resultHandler_;
+    stone_skipper::ChildReaper& childReaper_;
+    boost::process::async_pipe stdOutPipe_;
+    boost::process::async_pipe stdErrPipe_;
+    std::array<char, 4096> stdOutBuffer_;
+    std::array<char, 4096> stdErrBuffer_;
+    stone_skipper::ProcessResult result_{};
+    int pendingOperationsNumber_ = 3;
+};
+
+void launchWithCallbacks(
+        boost::asio::io_context& io,
+        const boost::filesystem::path& cmd,
+        const std::vector<std::string>& args,
+        int& launchesNumber,
+        const std::function<void()>& onFinished)
+{
+    if (launchesNumber == 0) {
+        onFinished();
+        return;
+    }
+    --launchesNumber;
+    std::make_shared<CallbackLaunch>(
+            io,
+            [&io, &cmd, &args, &launchesNumber, &onFinished](const stone_skipper::ProcessResult&)
+            {
+                launchWithCallbacks(io, cmd, args, launchesNumber, onFinished);
+            })
+            ->launch(cmd, args);
+}
+
+boost::asio::awaitable<void> launchWithCoroutines(
+        boost::asio::io_context& io,
+        const stone_skipper::ProcessCfg& processCfg,
+        int& launchesNumber)
+{
+    while (launchesNumber > 0) {
+        --launchesNumber;
+        co_await stone_skipper::asyncLaunchProcess(io, processCfg);
+    }
+}
+
+double measureCallbackPath(const std::string& command, int launchesNumber, int concurrency)
+{
+    auto io = boost::asio::io_context{};
+    auto args = std::vector<std::string>{"-c", command};
+    const auto cmd = boost::process::search_path("sh");
+    auto runningLaunchersNumber = concurrency;
+    const auto onFinished = std::function<void()>{[&]
+                                                  {
+                                                      if (--runningLaunchersNumber == 0)
+                                                          io.stop();
+                                                  }};
+    const auto beginTime = std::chrono::steady_clock::now();
+    for (auto i = 0; i < concurrency; ++i)
+        launchWithCallbacks(io, cmd, args, launchesNumber, onFinished);
+    io.run();
+    return std::chrono::duration<double>{std::chrono::steady_clock::now() - beginTime}.count();
+}
+
+double measureCoroutinePath(const std::string& command, int launchesNumber, int concurrency)
+{
+    auto io = boost::asio::io_context{};
+    auto processCfg = stone_skipper::ProcessCfg{};
+    processCfg.command = command;
+    processCfg.shellCommand =
+            std::make_shared<const std::vector<std::string>>(std::vector<std::string>{"sh", "-c"});
+    auto runningLaunchersNumber = concurrency;
+    const auto beginTime = std::chrono::steady_clock::now();
+    for (auto i = 0; i < concurrency; ++i)
+        boost::asio::co_spawn(
+                io,
+                launchWithCoroutines(io, processCfg, launchesNumber),
+                [&](std::exception_ptr)
+                {
+                    if (--runningLaunchersNumber == 0)
+                        io.stop();
+                });
+    io.run();
+    return std::chrono::duration<double>{std::chrono::steady_clock::now() - beginTime}.count();
+}
+
+} //namespace
+
+int main(int argc, char** argv)
+{
+    const auto launchesNumber = argc > 1 ? std::atoi(argv[1]) : 2000;
+    const auto commands = std::vector<std::string>{"true", "head -c 1048576 /dev/zero"};
+
+    fmt::print("{} launches of each command\n", launchesNumber);
+    fmt::print("{:<28}  {:>11}  {:>20}  {:>21}\n", "command", "concurrency", "callbacks, launches/s", "coroutines, launches/s");
+    for (const auto& command : commands)
+        for (const auto concurrency : {1, 8}) {
+            const auto callbackDuration = measureCallbackPath(command, launchesNumber, concurrency);
+            const auto coroutineDuration = measureCoroutinePath(command, launchesNumber, concurrency);
+            fmt::print(
+                    "{:<28}  {:>11}  {:>20.0f}  {:>21.0f}\n",
+                    command,
+                    concurrency,
+                    launchesNumber / callbackDuration,
+                    launchesNumber / coroutineDuration);
+            std::fflush(stdout);
+        }
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include <config.h>
+#include <task.h>
+#include <commandline.h>
+#include <figcone/configreader.h>
+#include <fmt/format.h>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+void writeConfig(const std::filesystem::path& configPath, int tasksNumber)
+{
+    auto stream = std::ofstream{configPath};
+    stream << "#tasks:\n";
+    for (auto i = 0; i < tasksNumber; ++i) {
+        stream << "###\n";
+        stream << fmt::format("  route = /task_{}/{{{{name}}}}\n", i);
+        if (i % 2 == 0)
+            stream << fmt::format("  command = echo \"Task {} greets {{{{name}}}}\"\n", i);
+        else
+            stream << fmt::format("  process = printf \"%s\" {} {{{{name}}}}\n", i);
+        if (i % 10 == 0)
+            stream << "  #env:\n    GREETING = Hello {{name}}\n";
+    }
+}
+
+double milliseconds(std::chrono::steady_clock::duration duration)
+{
+    return std::chrono::duration<double, std::milli>{duration}.count();
+}
+
+} //namespace
+
+int main()
+{
+    const auto configPath = std::filesystem::temp_directory_path() / "stone_skipper_bench_startup.shoal";
+    fmt::print(" tasks  config parsing, ms  tasks creation, ms  total, ms\n");
+    for (const auto tasksNumber : {100, 1000, 10000}) {
+        writeConfig(configPath, tasksNumber);
+        const auto beginTime = std::chrono::steady_clock::now();
+        auto configReader = figcone::ConfigReader{};
+        const auto config = configReader.readShoalFile<stone_skipper::Config>(configPath);
+        const auto configReadTime = std::chrono::steady_clock::now();
+        const auto tasks = stone_skipper::makeTasks(config.tasks, stone_skipper::defaultShellCommand());
+        const auto endTime = std::chrono::steady_clock::now();
+        fmt::print(
+                "{:>6}  {:>17.1f}  {:>18.1f}  {:>9.1f}\n",
+                tasks.size(),
+                milliseconds(configReadTime - beginTime),
+                milliseconds(endTime - configReadTime),
+                milliseconds(endTime - beginTime));
+    }
+    std::filesystem::remove(configPath);
+    return 0;
+}
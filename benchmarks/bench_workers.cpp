@@ -0,0 +1,79 @@
+#include <processcfg.h>
+#include <processlauncher.h>
+#include <supervisor.h>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include <boost/asio.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+namespace {
+
+boost::asio::awaitable<void> launchProcesses(
+        boost::asio::io_context& io,
+        const stone_skipper::ProcessCfg& processCfg,
+        int& launchesNumber)
+{
+    while (launchesNumber > 0) {
+        --launchesNumber;
+        co_await stone_skipper::asyncLaunchProcess(io, processCfg);
+    }
+}
+
+int runWorker(int launchesNumber, int concurrency, const std::function<void()>& onListening)
+{
+    auto io = boost::asio::io_context{};
+    auto processCfg = stone_skipper::ProcessCfg{};
+    processCfg.command = "true";
+    onListening();
+    auto runningLaunchersNumber = concurrency;
+    for (auto i = 0; i < concurrency; ++i)
+        boost::asio::co_spawn(
+                io,
+                launchProcesses(io, processCfg, launchesNumber),
+                [&](std::exception_ptr)
+                {
+                    if (--runningLaunchersNumber == 0)
+                        io.stop();
+                });
+    io.run();
+    return 0;
+}
+
+} //namespace
+
+int main(int argc, char** argv)
+{
+    const auto maxWorkersNumber = argc > 1 ? std::atoi(argv[1]) : static_cast<int>(std::thread::hardware_concurrency());
+    const auto launchesNumber = argc > 2 ? std::atoi(argv[2]) : 4000;
+    const auto concurrency = argc > 3 ? std::atoi(argv[3]) : 8;
+    spdlog::set_level(spdlog::level::warn);
+
+    fmt::print("{} launches of 'true', {} concurrent launches per worker\n", launchesNumber, concurrency);
+    fmt::print("workers  launches/s  speedup\n");
+    std::fflush(stdout);
+    auto oneWorkerRate = 0.0;
+    for (auto workersNumber = 1; workersNumber <= std::max(maxWorkersNumber, 1); workersNumber *= 2) {
+        const auto beginTime = std::chrono::steady_clock::now();
+        stone_skipper::runWorkers(
+                workersNumber,
+                [&](int workerIndex, const std::function<void()>& onListening)
+                {
+                    const auto workerLaunchesNumber =
+                            launchesNumber / workersNumber + (workerIndex < launchesNumber % workersNumber ? 1 : 0);
+                    return runWorker(workerLaunchesNumber, concurrency, onListening);
+                },
+                [] {});
+        const auto duration = std::chrono::duration<double>{std::chrono::steady_clock::now() - beginTime};
+        const auto rate = launchesNumber / duration.count();
+        if (workersNumber == 1)
+            oneWorkerRate = rate;
+        fmt::print("{:>7}  {:>10.0f}  {:>7.2f}\n", workersNumber, rate, rate / oneWorkerRate);
+        std::fflush(stdout);
+    }
+    return 0;
+}
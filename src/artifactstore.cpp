@@ -0,0 +1,201 @@
+#include "artifactstore.h"
+#include "errors.h"
+#include <fmt/format.h>
+#include <sfun/path.h>
+#ifndef _WIN32
+#include <signal.h>
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <functional>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace stone_skipper {
+
+namespace {
+
+const auto partFileExtension = std::string{".part"};
+const auto minEvictedArtifactAge = std::chrono::seconds{60};
+const auto cleanupInterval = std::chrono::seconds{10};
+
+struct ArtifactFile {
+    fs::path path;
+    fs::file_time_type modificationTime;
+    std::uintmax_t size;
+};
+
+std::uint64_t randomNumber()
+{
+    thread_local auto generator = std::mt19937_64{std::random_device{}()};
+    return generator();
+}
+
+int processId()
+{
+#ifndef _WIN32
+    return static_cast<int>(getpid());
+#else
+    return _getpid();
+#endif
+}
+
+bool isProcessRunning(int pid)
+{
+#ifndef _WIN32
+    return kill(pid, 0) == 0 || errno == EPERM;
+#else
+    return pid == processId();
+#endif
+}
+
+bool isAbandonedPartFile(const fs::path& path)
+{
+    const auto ownerPidString = path.stem().extension().string();
+    if (ownerPidString.empty())
+        return true;
+    auto ownerPid = 0;
+    const auto [end, error] =
+            std::from_chars(ownerPidString.data() + 1, ownerPidString.data() + ownerPidString.size(), ownerPid);
+    if (error != std::errc{} || end != ownerPidString.data() + ownerPidString.size() || ownerPid <= 0)
+        return true;
+    return !isProcessRunning(ownerPid);
+}
+
+} //namespace
+
+ArtifactStore::ArtifactStore(fs::path dir, ArtifactRetention retention, ArtifactHeader header, std::string location)
+    : retention_{retention}
+    , header_{header}
+    , location_{std::move(location)}
+{
+    auto error = std::error_code{};
+    fs::create_directories(dir, error);
+    if (error)
+        throw Error{fmt::format(
+                "Couldn't create the artifact directory {}: {}",
+                sfun::path_string(dir),
+                error.message())};
+    dir_ = fs::absolute(dir);
+    if (!location_.empty() && location_.back() != '/')
+        location_ += '/';
+    removeExpiredArtifacts();
+    cleanupThread_ = std::jthread{[this](std::stop_token stopToken)
+                                  {
+                                      cleanup(std::move(stopToken));
+                                  }};
+}
+
+ArtifactStore::~ArtifactStore()
+{
+    cleanupThread_.request_stop();
+    if (cleanupThread_.joinable())
+        cleanupThread_.join();
+}
+
+Artifact ArtifactStore::makeArtifact(const std::string& extension) const
+{
+    const auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch());
+    auto name = fmt::format("{}-{:016x}{}", timestamp.count(), randomNumber(), extension);
+    auto path = dir_ / name;
+    auto partPath = path;
+    partPath += fmt::format(".{}{}", processId(), partFileExtension);
+    return Artifact{.name = std::move(name), .path = std::move(path), .partPath = std::move(partPath)};
+}
+
+void ArtifactStore::commit(const Artifact& artifact) const
+{
+    auto error = std::error_code{};
+    fs::rename(artifact.partPath, artifact.path, error);
+    if (error)
+        throw Error{fmt::format(
+                "Couldn't save the artifact {}: {}",
+                sfun::path_string(artifact.path),
+                error.message())};
+}
+
+void ArtifactStore::discard(const Artifact& artifact) const
+{
+    auto error = std::error_code{};
+    fs::remove(artifact.partPath, error);
+}
+
+std::string ArtifactStore::headerName() const
+{
+    return header_ == ArtifactHeader::AccelRedirect ? "X-Accel-Redirect" : "X-Sendfile";
+}
+
+std::string ArtifactStore::headerValue(const Artifact& artifact) const
+{
+    if (header_ == ArtifactHeader::AccelRedirect)
+        return location_ + artifact.name;
+    return sfun::path_string(artifact.path);
+}
+
+void ArtifactStore::cleanup(std::stop_token stopToken)
+{
+    auto lock = std::unique_lock{cleanupMutex_};
+    while (!stopToken.stop_requested()) {
+        cleanupRequested_.wait_for(
+                lock,
+                stopToken,
+                cleanupInterval,
+                []
+                {
+                    return false;
+                });
+        if (stopToken.stop_requested())
+            return;
+        removeExpiredArtifacts();
+    }
+}
+
+void ArtifactStore::removeExpiredArtifacts() const
+{
+    const auto now = fs::file_time_type::clock::now();
+    auto artifactFiles = std::vector<ArtifactFile>{};
+    auto error = std::error_code{};
+    for (const auto& entry : fs::directory_iterator{dir_, error}) {
+        if (!entry.is_regular_file(error))
+            continue;
+        if (entry.path().extension() == partFileExtension) {
+            if (isAbandonedPartFile(entry.path()))
+                fs::remove(entry.path(), error);
+            continue;
+        }
+        const auto modificationTime = entry.last_write_time(error);
+        if (error)
+            continue;
+        if (retention_.maxAge.count() > 0 && now - modificationTime > retention_.maxAge) {
+            fs::remove(entry.path(), error);
+            continue;
+        }
+        const auto size = entry.file_size(error);
+        if (!error)
+            artifactFiles.push_back({entry.path(), modificationTime, size});
+    }
+
+    std::ranges::sort(artifactFiles, std::greater<>{}, &ArtifactFile::modificationTime);
+    auto artifactsNumber = 0;
+    auto artifactsSize = std::uintmax_t{};
+    for (const auto& artifactFile : artifactFiles) {
+        const auto isOverCountLimit = retention_.maxCount > 0 && artifactsNumber + 1 > retention_.maxCount;
+        const auto isOverSizeLimit = retention_.maxSize > 0 && artifactsSize + artifactFile.size > retention_.maxSize;
+        if ((isOverCountLimit || isOverSizeLimit) && now - artifactFile.modificationTime > minEvictedArtifactAge) {
+            fs::remove(artifactFile.path, error);
+            continue;
+        }
+        ++artifactsNumber;
+        artifactsSize += artifactFile.size;
+    }
+}
+
+} //namespace stone_skipper
@@ -0,0 +1,57 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <thread>
+
+namespace stone_skipper {
+
+enum class ArtifactHeader {
+    AccelRedirect,
+    Sendfile
+};
+
+struct ArtifactRetention {
+    std::chrono::seconds maxAge;
+    int maxCount;
+    std::uintmax_t maxSize;
+};
+
+struct Artifact {
+    std::string name;
+    std::filesystem::path path;
+    std::filesystem::path partPath;
+};
+
+class ArtifactStore {
+public:
+    ArtifactStore(std::filesystem::path dir, ArtifactRetention retention, ArtifactHeader header, std::string location);
+    ~ArtifactStore();
+    ArtifactStore(const ArtifactStore&) = delete;
+    ArtifactStore& operator=(const ArtifactStore&) = delete;
+
+    Artifact makeArtifact(const std::string& extension) const;
+    void commit(const Artifact&) const;
+    void discard(const Artifact&) const;
+    std::string headerName() const;
+    std::string headerValue(const Artifact&) const;
+
+private:
+    void removeExpiredArtifacts() const;
+    void cleanup(std::stop_token);
+
+private:
+    std::filesystem::path dir_;
+    ArtifactRetention retention_;
+    ArtifactHeader header_;
+    std::string location_;
+    std::mutex cleanupMutex_;
+    std::condition_variable_any cleanupRequested_;
+    std::jthread cleanupThread_;
+};
+
+} //namespace stone_skipper
@@ -0,0 +1,89 @@
+#include "childreaper.h"
+#ifndef _WIN32
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#endif
+#include <utility>
+#include <vector>
+
+namespace stone_skipper {
+
+#ifndef _WIN32
+ChildReaper::ChildReaper(boost::asio::io_context& io)
+    : boost::asio::execution_context::service{io}
+    , childExitSignal_{io, SIGCHLD}
+{
+    waitForChildExit();
+}
+
+void ChildReaper::watch(int pid, ExitHandler exitHandler)
+{
+    auto childExit = std::optional<ChildExit>{};
+    {
+        auto lock = std::scoped_lock{mutex_};
+        childExit = reapChild(pid);
+        if (!childExit.has_value()) {
+            exitHandlers_.emplace(pid, std::move(exitHandler));
+            return;
+        }
+    }
+    exitHandler(childExit->status, childExit->resourceUsage);
+}
+
+bool ChildReaper::hasExited(int pid)
+{
+    auto childInfo = siginfo_t{};
+    return waitid(P_PID, static_cast<id_t>(pid), &childInfo, WEXITED | WNOHANG | WNOWAIT) == 0 &&
+            childInfo.si_pid == pid;
+}
+
+void ChildReaper::shutdown()
+{
+    auto error = boost::system::error_code{};
+    childExitSignal_.cancel(error);
+    auto lock = std::scoped_lock{mutex_};
+    exitHandlers_.clear();
+}
+
+void ChildReaper::waitForChildExit()
+{
+    childExitSignal_.async_wait(
+            [this](const boost::system::error_code& ec, int)
+            {
+                if (ec)
+                    return;
+                reapChildren();
+                waitForChildExit();
+            });
+}
+
+void ChildReaper::reapChildren()
+{
+    auto exitedChildren = std::vector<std::pair<ExitHandler, ChildExit>>{};
+    {
+        auto lock = std::scoped_lock{mutex_};
+        for (auto it = exitHandlers_.begin(); it != exitHandlers_.end();) {
+            if (auto childExit = reapChild(it->first)) {
+                exitedChildren.emplace_back(std::move(it->second), *childExit);
+                it = exitHandlers_.erase(it);
+            }
+            else
+                ++it;
+        }
+    }
+    for (auto& [exitHandler, childExit] : exitedChildren)
+        exitHandler(childExit.status, childExit.resourceUsage);
+}
+
+std::optional<ChildReaper::ChildExit> ChildReaper::reapChild(int pid)
+{
+    auto status = 0;
+    auto usage = rusage{};
+    if (wait4(pid, &status, WNOHANG, &usage) != pid)
+        return std::nullopt;
+    return ChildExit{status, makeResourceUsage(usage)};
+}
+#endif
+
+} //namespace stone_skipper
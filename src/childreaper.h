@@ -0,0 +1,42 @@
+#pragma once
+#include "resourceusage.h"
+#include <boost/asio/execution_context.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/signal_set.hpp>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+
+namespace stone_skipper {
+
+#ifndef _WIN32
+class ChildReaper : public boost::asio::execution_context::service {
+public:
+    using ExitHandler = std::function<void(int status, const ResourceUsage&)>;
+    using key_type = ChildReaper;
+    static inline boost::asio::execution_context::id id;
+
+    explicit ChildReaper(boost::asio::io_context& io);
+    void watch(int pid, ExitHandler exitHandler);
+    static bool hasExited(int pid);
+
+private:
+    struct ChildExit {
+        int status;
+        ResourceUsage resourceUsage;
+    };
+
+    void shutdown() override;
+    void waitForChildExit();
+    void reapChildren();
+    static std::optional<ChildExit> reapChild(int pid);
+
+private:
+    boost::asio::signal_set childExitSignal_;
+    std::mutex mutex_;
+    std::map<int, ExitHandler> exitHandlers_;
+};
+#endif
+
+} //namespace stone_skipper
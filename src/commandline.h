@@ -44,6 +44,71 @@ struct CommandLine : cmdlime::Config {
             if (value && *value <= 0)
                 throw cmdlime::ValidationError{"threads number must be positive"};
         };
+    CMDLIME_PARAM(workers, int)(1)                                  << "number of worker processes"
+        << [](std::optional<int> value)
+        {
+            if (value && *value <= 0)
+                throw cmdlime::ValidationError{"workers number must be positive"};
+        };
+    CMDLIME_PARAM(maxProcesses, int)(0)                             << "maximum number of simultaneously running processes (0 - unlimited)"
+        << [](std::optional<int> value)
+        {
+            if (value && *value < 0)
+                throw cmdlime::ValidationError{"maximum number of processes can't be negative"};
+        };
+    CMDLIME_PARAM(shellPool, int)(0)                                << "maximum number of pre-started shell processes (0 - disabled)"
+        << [](std::optional<int> value)
+        {
+            if (value && *value < 0)
+                throw cmdlime::ValidationError{"shell pool size can't be negative"};
+        };
+    CMDLIME_PARAM(jobBufferSize, int)(0)                            << "size in bytes of the output buffer kept for each detached task (0 - disabled)"
+        << [](std::optional<int> value)
+        {
+            if (value && *value < 0)
+                throw cmdlime::ValidationError{"job buffer size can't be negative"};
+        };
+    CMDLIME_PARAM(artifactDir, cmdlime::optional<std::filesystem::path>) << "directory for the output files of the artifact tasks";
+    CMDLIME_PARAM(artifactHeader, std::string)("X-Accel-Redirect")  << "response header with the artifact location (X-Accel-Redirect or X-Sendfile)"
+        << [](std::optional<std::string> value)
+        {
+            if (value && *value != "X-Accel-Redirect" && *value != "X-Sendfile")
+                throw cmdlime::ValidationError{"artifact header must be either 'X-Accel-Redirect' or 'X-Sendfile'"};
+        };
+    CMDLIME_PARAM(artifactLocation, std::string)("/artifacts/")     << "URI prefix of the artifacts in the X-Accel-Redirect header";
+    CMDLIME_PARAM(artifactMaxAge, int)(3600)                        << "time in seconds after which the artifacts are removed (0 - unlimited)"
+        << [](std::optional<int> value)
+        {
+            if (value && *value < 0)
+                throw cmdlime::ValidationError{"artifact max age can't be negative"};
+        };
+    CMDLIME_PARAM(artifactMaxCount, int)(100)                       << "maximum number of stored artifacts (0 - unlimited)"
+        << [](std::optional<int> value)
+        {
+            if (value && *value < 0)
+                throw cmdlime::ValidationError{"artifact max count can't be negative"};
+        };
+    CMDLIME_PARAM(artifactMaxSize, int)(1024)                       << "maximum total size of stored artifacts in megabytes (0 - unlimited)"
+        << [](std::optional<int> value)
+        {
+            if (value && *value < 0)
+                throw cmdlime::ValidationError{"artifact max size can't be negative"};
+        };
+    CMDLIME_PARAM(traceFile, cmdlime::optional<std::filesystem::path>) << "request trace file path (Chrome trace format)";
+    CMDLIME_PARAM(traceSampling, double)(1.0)                       << "fraction of the traced requests"
+        << [](std::optional<double> value)
+        {
+            if (value && (*value <= 0.0 || *value > 1.0))
+                throw cmdlime::ValidationError{"trace sampling must be in the range (0, 1]"};
+        };
+    CMDLIME_PARAM(pidFile, cmdlime::optional<std::filesystem::path>)   << "pid file path";
+    CMDLIME_PARAM(drainTimeout, int)(30)                            << "time in seconds given to the running tasks and requests to finish on drain"
+        << [](std::optional<int> value)
+        {
+            if (value && *value < 0)
+                throw cmdlime::ValidationError{"drain timeout can't be negative"};
+        };
+    CMDLIME_FLAG(upgrade)                                           << "replace the running instance registered in the pid file";
 };
 // clang-format on
 
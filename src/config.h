@@ -3,6 +3,7 @@
 #include <figcone/config.h>
 #include <sfun/string_utils.h>
 #include <filesystem>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -24,6 +25,57 @@ struct TaskIsValid {
             throw figcone::ValidationError{"a task must have 'command' or 'process' parameter set"};
         if (!task.command.empty() && !task.process.empty())
             throw figcone::ValidationError{"a task can't have both 'command' and 'process' parameters set"};
+        if (task.cgroup.empty() && (!task.cpuMax.empty() || !task.memoryMax.empty()))
+            throw figcone::ValidationError{"a task must have 'cgroup' parameter set to use 'cpuMax' or 'memoryMax'"};
+    }
+};
+
+struct PriorityClassesAreValid {
+    void operator()(const std::map<std::string, int>& priorityClasses)
+    {
+        for (const auto& [name, weight] : priorityClasses)
+            if (weight <= 0)
+                throw figcone::ValidationError{"priority class '" + name + "' must have a positive weight"};
+    }
+};
+
+struct IsPositive {
+    void operator()(int value)
+    {
+        if (value <= 0)
+            throw figcone::ValidationError{"must be positive"};
+    }
+};
+
+struct IsNiceIncrement {
+    void operator()(int value)
+    {
+        if (value < -20 || value > 19)
+            throw figcone::ValidationError{"must be in the range [-20, 19]"};
+    }
+};
+
+struct IsIoniceClass {
+    void operator()(const std::string& value)
+    {
+        if (!value.empty() && value != "realtime" && value != "best-effort" && value != "idle")
+            throw figcone::ValidationError{"must be one of 'realtime', 'best-effort' or 'idle'"};
+    }
+};
+
+struct IsIoniceLevel {
+    void operator()(int value)
+    {
+        if (value < 0 || value > 7)
+            throw figcone::ValidationError{"must be in the range [0, 7]"};
+    }
+};
+
+struct IsFileExtension {
+    void operator()(const std::string& value)
+    {
+        if (value.find_first_of("/\\") != std::string::npos)
+            throw figcone::ValidationError{"can't contain path separators"};
     }
 };
 
@@ -40,9 +92,25 @@ struct TaskConfig : figcone::Config {
     FIGCONE_PARAM(command, std::string)();
     FIGCONE_PARAM(process, std::string)();
     FIGCONE_PARAM(workingDir, std::filesystem::path)(homePath());
+    FIGCONE_PARAM(priority, std::string)();
+    FIGCONE_DICT(env, std::map<std::string, std::string>)();
+    FIGCONE_PARAM(clearEnv, bool)(false);
+    FIGCONE_PARAM(batchParallelism, int)(4).ensure<IsPositive>();
+    FIGCONE_PARAM(batchMaxItems, int)(100).ensure<IsPositive>();
+    FIGCONE_PARAM(resourceUsageHeaders, bool)(false);
+    FIGCONE_PARAM(cpuAffinity, std::string)();
+    FIGCONE_PARAM(nice, int)(0).ensure<IsNiceIncrement>();
+    FIGCONE_PARAM(ioniceClass, std::string)().ensure<IsIoniceClass>();
+    FIGCONE_PARAM(ioniceLevel, int)(4).ensure<IsIoniceLevel>();
+    FIGCONE_PARAM(cgroup, std::string)();
+    FIGCONE_PARAM(cpuMax, std::string)();
+    FIGCONE_PARAM(memoryMax, std::string)();
+    FIGCONE_PARAM(artifact, bool)(false);
+    FIGCONE_PARAM(artifactExtension, std::string)().ensure<IsFileExtension>();
 };
 
 struct Config : figcone::Config {
+    FIGCONE_DICT(priorityClasses, std::map<std::string, int>)().ensure<PriorityClassesAreValid>();
     FIGCONE_NODELIST(tasks, std::vector<TaskConfig>).ensure<AllTasksAreValid>();
 };
 } //namespace stone_skipper
@@ -0,0 +1,189 @@
+#include "jobregistry.h"
+#include <fmt/format.h>
+#include <sfun/contract.h>
+#include <boost/asio.hpp>
+#include <algorithm>
+#include <utility>
+
+namespace stone_skipper {
+
+JobOutput::JobOutput(std::size_t bufferSize)
+    : ring_{bufferSize}
+{
+}
+
+void JobOutput::write(std::string_view data)
+{
+    {
+        auto lock = std::scoped_lock{mutex_};
+        ring_.write(data);
+    }
+    notifyWaiters();
+}
+
+void JobOutput::finish(int exitCode)
+{
+    {
+        auto lock = std::scoped_lock{mutex_};
+        exitCode_ = exitCode;
+    }
+    notifyWaiters();
+}
+
+bool JobOutput::isFinished() const
+{
+    auto lock = std::scoped_lock{mutex_};
+    return exitCode_.has_value();
+}
+
+boost::asio::awaitable<JobOutputTail> JobOutput::tail(std::size_t offset, std::chrono::milliseconds timeout)
+{
+    if (auto result = readTail(offset))
+        co_return std::move(result.value());
+    co_await waitForOutput(offset, timeout);
+    if (auto result = readTail(offset))
+        co_return std::move(result.value());
+    auto lock = std::scoped_lock{mutex_};
+    const auto slice = ring_.read(offset);
+    co_return JobOutputTail{.data = {}, .offset = slice.offset, .nextOffset = slice.nextOffset, .exitCode = {}};
+}
+
+std::optional<JobOutputTail> JobOutput::readTail(std::size_t offset) const
+{
+    auto lock = std::scoped_lock{mutex_};
+    if (offset < ring_.endOffset() || exitCode_.has_value()) {
+        auto slice = ring_.read(offset);
+        return JobOutputTail{
+                .data = std::move(slice.data),
+                .offset = slice.offset,
+                .nextOffset = slice.nextOffset,
+                .exitCode = exitCode_};
+    }
+    return std::nullopt;
+}
+
+boost::asio::awaitable<void> JobOutput::waitForOutput(std::size_t offset, std::chrono::milliseconds timeout)
+{
+    auto timer = boost::asio::steady_timer{co_await boost::asio::this_coro::executor, timeout};
+    co_await boost::asio::async_initiate<const boost::asio::use_awaitable_t<>&, void()>(
+            [&](auto handler)
+            {
+                auto sharedHandler = std::make_shared<decltype(handler)>(std::move(handler));
+                auto isResumed = std::make_shared<std::atomic_flag>();
+                auto resume = [sharedHandler, isResumed]
+                {
+                    if (isResumed->test_and_set())
+                        return;
+                    const auto executor = boost::asio::get_associated_executor(*sharedHandler);
+                    boost::asio::post(executor, std::move(*sharedHandler));
+                };
+                auto lock = std::unique_lock{mutex_};
+                if (offset < ring_.endOffset() || exitCode_.has_value()) {
+                    lock.unlock();
+                    resume();
+                    return;
+                }
+                std::erase_if(
+                        waiters_,
+                        [](const OutputWaiter& waiter)
+                        {
+                            return waiter.isResumed->test();
+                        });
+                waiters_.push_back({isResumed, resume});
+                lock.unlock();
+                timer.async_wait(
+                        [resume](const boost::system::error_code&)
+                        {
+                            resume();
+                        });
+            },
+            boost::asio::use_awaitable);
+    timer.cancel();
+}
+
+void JobOutput::notifyWaiters()
+{
+    auto waiters = std::vector<OutputWaiter>{};
+    {
+        auto lock = std::scoped_lock{mutex_};
+        std::swap(waiters, waiters_);
+    }
+    for (const auto& waiter : waiters)
+        waiter.resume();
+}
+
+JobRegistry::JobRegistry(std::size_t bufferSize, std::size_t finishedJobsNumber, int workerIndex, int workersNumber)
+    : bufferSize_{bufferSize}
+    , finishedJobsNumber_{finishedJobsNumber}
+    , workerIndex_{workerIndex}
+    , workersNumber_{workersNumber}
+{
+    sfun_contract_check(workersNumber_ > 0 && workerIndex_ >= 0 && workerIndex_ < workersNumber_);
+}
+
+std::pair<std::int64_t, std::shared_ptr<JobOutput>> JobRegistry::addJob()
+{
+    auto lock = std::scoped_lock{mutex_};
+    const auto finishedJobsNumber = static_cast<std::size_t>(std::ranges::count_if(
+            jobs_,
+            [](const auto& job)
+            {
+                return job.second->isFinished();
+            }));
+    auto removedJobsNumber = finishedJobsNumber - std::min(finishedJobsNumber, finishedJobsNumber_);
+    for (auto it = jobs_.begin(); it != jobs_.end() && removedJobsNumber > 0;) {
+        if (it->second->isFinished()) {
+            it = jobs_.erase(it);
+            --removedJobsNumber;
+        }
+        else
+            ++it;
+    }
+
+    const auto jobId = nextJobNumber_++ * workersNumber_ + workerIndex_;
+    auto job = std::make_shared<JobOutput>(bufferSize_);
+    jobs_.emplace(jobId, job);
+    return {jobId, std::move(job)};
+}
+
+std::shared_ptr<JobOutput> JobRegistry::job(std::int64_t jobId) const
+{
+    if (!isOwnJob(jobId))
+        return nullptr;
+    auto lock = std::scoped_lock{mutex_};
+    const auto it = jobs_.find(jobId);
+    if (it == jobs_.end())
+        return nullptr;
+    return it->second;
+}
+
+bool JobRegistry::isOwnJob(std::int64_t jobId) const
+{
+    return jobId > 0 && jobId % workersNumber_ == workerIndex_;
+}
+
+int JobRegistry::workerIndex() const
+{
+    return workerIndex_;
+}
+
+std::string JobRegistry::jobPath(std::int64_t jobId) const
+{
+    return stone_skipper::jobPath(jobId, workersNumber_);
+}
+
+std::string jobRoutePattern(int workersNumber)
+{
+    if (workersNumber == 1)
+        return "/jobs/(\\d+)";
+    return "/jobs/(\\d+)/(\\d+)";
+}
+
+std::string jobPath(std::int64_t jobId, int workersNumber)
+{
+    if (workersNumber == 1)
+        return fmt::format("/jobs/{}", jobId);
+    return fmt::format("/jobs/{}/{}", jobId % workersNumber, jobId);
+}
+
+} //namespace stone_skipper
@@ -0,0 +1,72 @@
+#pragma once
+#include "outputring.h"
+#include <boost/asio/awaitable.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace stone_skipper {
+
+struct JobOutputTail {
+    std::string data;
+    std::size_t offset = 0;
+    std::size_t nextOffset = 0;
+    std::optional<int> exitCode;
+};
+
+class JobOutput {
+public:
+    explicit JobOutput(std::size_t bufferSize);
+    void write(std::string_view data);
+    void finish(int exitCode);
+    bool isFinished() const;
+    boost::asio::awaitable<JobOutputTail> tail(std::size_t offset, std::chrono::milliseconds timeout);
+
+private:
+    struct OutputWaiter {
+        std::shared_ptr<std::atomic_flag> isResumed;
+        std::function<void()> resume;
+    };
+
+    std::optional<JobOutputTail> readTail(std::size_t offset) const;
+    boost::asio::awaitable<void> waitForOutput(std::size_t offset, std::chrono::milliseconds timeout);
+    void notifyWaiters();
+
+private:
+    mutable std::mutex mutex_;
+    OutputRing ring_;
+    std::optional<int> exitCode_;
+    std::vector<OutputWaiter> waiters_;
+};
+
+class JobRegistry {
+public:
+    JobRegistry(std::size_t bufferSize, std::size_t finishedJobsNumber, int workerIndex = 0, int workersNumber = 1);
+    std::pair<std::int64_t, std::shared_ptr<JobOutput>> addJob();
+    std::shared_ptr<JobOutput> job(std::int64_t jobId) const;
+    bool isOwnJob(std::int64_t jobId) const;
+    int workerIndex() const;
+    std::string jobPath(std::int64_t jobId) const;
+
+private:
+    std::size_t bufferSize_;
+    std::size_t finishedJobsNumber_;
+    int workerIndex_;
+    int workersNumber_;
+    mutable std::mutex mutex_;
+    std::map<std::int64_t, std::shared_ptr<JobOutput>> jobs_;
+    std::int64_t nextJobNumber_ = 1;
+};
+
+std::string jobRoutePattern(int workersNumber);
+std::string jobPath(std::int64_t jobId, int workersNumber);
+
+} //namespace stone_skipper
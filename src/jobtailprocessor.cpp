@@ -0,0 +1,91 @@
+#include "jobtailprocessor.h"
+#include "jobregistry.h"
+#include <boost/asio.hpp>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace stone_skipper {
+
+namespace {
+
+const auto longPollTimeout = std::chrono::seconds{30};
+
+template<typename T>
+std::optional<T> readNumber(std::string_view str)
+{
+    auto number = T{};
+    const auto [end, error] = std::from_chars(str.data(), str.data() + str.size(), number);
+    if (error != std::errc{} || end != str.data() + str.size())
+        return std::nullopt;
+    return number;
+}
+
+boost::asio::awaitable<void> sendJobTail(
+        std::shared_ptr<JobOutput> job,
+        std::size_t offset,
+        asyncgi::Response response,
+        [[maybe_unused]] RequestCounter::RequestHandle activeRequest)
+{
+    const auto tail = co_await job->tail(offset, longPollTimeout);
+    auto httpResponse = asyncgi::http::Response{asyncgi::http::ResponseStatus::_200_Ok, tail.data};
+    httpResponse.addHeader(asyncgi::http::Header{"X-Job-Offset", std::to_string(tail.offset)});
+    httpResponse.addHeader(asyncgi::http::Header{"X-Job-Next-Offset", std::to_string(tail.nextOffset)});
+    if (tail.exitCode.has_value())
+        httpResponse.addHeader(asyncgi::http::Header{"X-Job-Exit-Code", std::to_string(tail.exitCode.value())});
+    response.send(httpResponse);
+}
+
+} //namespace
+
+JobTailProcessor::JobTailProcessor(JobRegistry& jobRegistry, RequestCounter& requestCounter)
+    : jobRegistry_{jobRegistry}
+    , requestCounter_{requestCounter}
+{
+}
+
+void JobTailProcessor::operator()(
+        const asyncgi::RouteParameters<>& routeParams,
+        const asyncgi::Request& request,
+        asyncgi::Response& response) const
+{
+    const auto jobId = readNumber<std::int64_t>(routeParams.value.back());
+    const auto workerIndex = routeParams.value.size() > 1 ? readNumber<int>(routeParams.value.front()) : 0;
+    if (jobId.has_value() &&
+        (!jobRegistry_.get().isOwnJob(jobId.value()) || workerIndex != jobRegistry_.get().workerIndex())) {
+        response.send(asyncgi::http::ResponseStatus::_404_Not_Found, "Job was launched by another worker");
+        return;
+    }
+    auto job = jobId.has_value() ? jobRegistry_.get().job(jobId.value()) : nullptr;
+    if (!job) {
+        response.send(asyncgi::http::ResponseStatus::_404_Not_Found, "Unknown job");
+        return;
+    }
+    const auto offset = request.hasQuery("offset") ? readNumber<std::size_t>(request.query("offset")) : std::size_t{};
+    if (!offset.has_value()) {
+        response.send(asyncgi::http::ResponseStatus::_422_Unprocessable_Entity, "Job output offset must be a number");
+        return;
+    }
+
+    auto activeRequest = requestCounter_.get().startRequest();
+    if (!activeRequest) {
+        response.send(asyncgi::http::ResponseStatus::_503_Service_Unavailable, "Server is stopping");
+        return;
+    }
+
+    auto disp = asyncgi::AsioDispatcher{response};
+    disp.postTask(
+            [job = std::move(job), offset = offset.value(), response, activeRequest = std::move(activeRequest)](
+                    const asyncgi::TaskContext& ctx) mutable
+            {
+                boost::asio::co_spawn(
+                        ctx.io(),
+                        sendJobTail(std::move(job), offset, response, std::move(activeRequest)),
+                        boost::asio::detached);
+            });
+}
+
+} //namespace stone_skipper
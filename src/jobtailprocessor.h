@@ -0,0 +1,18 @@
+#pragma once
+#include "requestcounter.h"
+#include <asyncgi/asyncgi.h>
+#include <sfun/member.h>
+
+namespace stone_skipper {
+class JobRegistry;
+
+struct JobTailProcessor {
+    JobTailProcessor(JobRegistry&, RequestCounter&);
+    void operator()(const asyncgi::RouteParameters<>&, const asyncgi::Request&, asyncgi::Response&) const;
+
+private:
+    sfun::member<JobRegistry&> jobRegistry_;
+    sfun::member<RequestCounter&> requestCounter_;
+};
+
+} //namespace stone_skipper
@@ -1,45 +1,144 @@
+#include "artifactstore.h"
 #include "commandline.h"
 #include "config.h"
+#include "errors.h"
+#include "jobregistry.h"
+#include "jobtailprocessor.h"
+#include "requestcounter.h"
+#include "shellpool.h"
+#include "supervisor.h"
 #include "task.h"
 #include "taskprocessor.h"
+#include "taskscheduler.h"
+#include "tracer.h"
+#include "upgrade.h"
+#include "utils.h"
 #include <asyncgi/asyncgi.h>
 #include <cmdlime/commandlinereader.h>
 #include <figcone/configreader.h>
+#include <fmt/format.h>
 #include <sfun/functional.h>
+#include <sfun/string_utils.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
+#include <chrono>
 #include <filesystem>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
 
 using namespace stone_skipper;
 namespace fs = std::filesystem;
 namespace http = asyncgi::http;
 
+const auto maxTraceFileSize = std::uintmax_t{64} * 1024 * 1024;
+const auto finishedJobsNumber = std::size_t{100};
+
 void createDefaultLogger(const fs::path& logPath);
 void createDefaultConfig();
 
-int mainApp(const CommandLine& commandLine)
+fs::path workerPath(const fs::path& path, std::optional<int> workerIndex)
 {
-    createDefaultConfig();
-    if (commandLine.log.has_value())
-        createDefaultLogger(commandLine.log.value());
+    if (!workerIndex.has_value())
+        return path;
+    auto result = path;
+    result += "." + std::to_string(workerIndex.value());
+    return result;
+}
 
-    auto configReader = figcone::ConfigReader{};
-    auto config = configReader.readShoalFile<Config>(commandLine.config);
-    spdlog::info("Configuration was read from {}", sfun::path_string(commandLine.config));
+FcgiHost workerFcgiAddress(const FcgiHost& fcgiAddress, std::optional<int> workerIndex)
+{
+    return std::visit(
+            sfun::overloaded{
+                    [&](const TcpHost& host) -> FcgiHost
+                    {
+                        return TcpHost{host.ipAddress, static_cast<uint16_t>(host.port + workerIndex.value_or(0))};
+                    },
+                    [&](const UnixDomainHost& host) -> FcgiHost
+                    {
+                        return UnixDomainHost{workerPath(host.path, workerIndex)};
+                    }},
+            fcgiAddress);
+}
+
+int runServer(
+        const CommandLine& commandLine,
+        const std::vector<std::shared_ptr<const Task>>& tasks,
+        TaskScheduler& scheduler,
+        const std::function<void()>& onListening,
+        std::optional<int> workerIndex = {})
+{
+    blockDrainSignal();
+    auto tracer = std::unique_ptr<Tracer>{};
+    if (commandLine.traceFile.has_value())
+        tracer = std::make_unique<Tracer>(
+                workerPath(commandLine.traceFile.value(), workerIndex),
+                commandLine.traceSampling,
+                maxTraceFileSize);
 
     auto io = asyncgi::IO{commandLine.threads};
+    auto shellPool = std::unique_ptr<ShellPool>{};
+    if (commandLine.shellPool > 0)
+        shellPool = std::make_unique<ShellPool>(splitCommand(commandLine.shell), commandLine.shellPool);
+    auto jobRegistry = std::unique_ptr<JobRegistry>{};
+    if (commandLine.jobBufferSize > 0)
+        jobRegistry = std::make_unique<JobRegistry>(
+                static_cast<std::size_t>(commandLine.jobBufferSize),
+                finishedJobsNumber,
+                workerIndex.value_or(0),
+                commandLine.workers);
+    auto artifactStore = std::unique_ptr<ArtifactStore>{};
+    if (commandLine.artifactDir.has_value())
+        artifactStore = std::make_unique<ArtifactStore>(
+                commandLine.artifactDir.value(),
+                ArtifactRetention{
+                        .maxAge = std::chrono::seconds{commandLine.artifactMaxAge},
+                        .maxCount = commandLine.artifactMaxCount,
+                        .maxSize = std::uintmax_t{static_cast<unsigned>(commandLine.artifactMaxSize)} * 1024 * 1024},
+                commandLine.artifactHeader == "X-Sendfile" ? ArtifactHeader::Sendfile : ArtifactHeader::AccelRedirect,
+                commandLine.artifactLocation);
+
+    auto requestCounter = RequestCounter{};
     auto router = asyncgi::Router{};
-    for (const auto& taskCfg : config.tasks){
-        const auto task = Task{taskCfg, commandLine.shell};
-        router.route(task.routeRegexp, http::RequestMethod::Get).process<TaskProcessor<TaskLaunchMode::WaitingForResult>>(task);
-        router.route(task.routeRegexp, http::RequestMethod::Post).process<TaskProcessor<TaskLaunchMode::Detached>>(task);
+    for (const auto& task : tasks)
+        router.route(task->batchRouteRegexp, http::RequestMethod::Post)
+                .process<TaskProcessor<TaskLaunchMode::Batch>>(
+                        task,
+                        scheduler,
+                        requestCounter,
+                        tracer.get(),
+                        shellPool.get(),
+                        jobRegistry.get(),
+                        artifactStore.get());
+    for (const auto& task : tasks) {
+        router.route(task->routeRegexp, http::RequestMethod::Get)
+                .process<TaskProcessor<TaskLaunchMode::WaitingForResult>>(
+                        task,
+                        scheduler,
+                        requestCounter,
+                        tracer.get(),
+                        shellPool.get(),
+                        jobRegistry.get(),
+                        artifactStore.get());
+        router.route(task->routeRegexp, http::RequestMethod::Post)
+                .process<TaskProcessor<TaskLaunchMode::Detached>>(
+                        task,
+                        scheduler,
+                        requestCounter,
+                        tracer.get(),
+                        shellPool.get(),
+                        jobRegistry.get(),
+                        artifactStore.get());
     }
+    if (jobRegistry)
+        router.route(asyncgi::rx{jobRoutePattern(commandLine.workers)}, http::RequestMethod::Get)
+                .process<JobTailProcessor>(*jobRegistry, requestCounter);
     router.route().set(http::ResponseStatus::_404_Not_Found, "Unknown task");
-    if (config.tasks.empty())
-        spdlog::warn("No tasks were found in the config");
 
     auto server = asyncgi::Server{io, router};
+    const auto fcgiAddress = workerFcgiAddress(commandLine.fcgiAddress, workerIndex);
     std::visit(
             sfun::overloaded{
                     [&](const TcpHost& host)
@@ -48,16 +147,139 @@ int mainApp(const CommandLine& commandLine)
                     },
                     [&](const UnixDomainHost& host)
                     {
-                        server.listen(host.path);
+                        if (commandLine.upgrade)
+                            listenOnReplacedSocket(
+                                    host.path,
+                                    [&](const fs::path& socketPath)
+                                    {
+                                        server.listen(socketPath);
+                                    });
+                        else
+                            server.listen(host.path);
                     }},
-            commandLine.fcgiAddress);
+            fcgiAddress);
+    onListening();
+
+    const auto drainHandler = DrainHandler{
+            std::holds_alternative<UnixDomainHost>(fcgiAddress)
+                    ? std::optional{std::get<UnixDomainHost>(fcgiAddress).path}
+                    : std::nullopt,
+            std::chrono::seconds{commandLine.drainTimeout},
+            [&scheduler, &requestCounter]
+            {
+                return scheduler.hasActiveTasks() || requestCounter.activeRequestsNumber() > 0;
+            },
+            [&requestCounter]
+            {
+                requestCounter.stopAcceptingRequests();
+            },
+            [&io]
+            {
+                io.stop();
+            }};
 
     spdlog::info("stone_skipper task server has started");
     io.run();
+    for (const auto& task : tasks)
+        if (const auto processesNumber = task->resourceUsageStats->processesNumber())
+            spdlog::info(
+                    "Task '{}' launched {} processes, total {}",
+                    task->route,
+                    processesNumber,
+                    resourceUsageDescription(task->resourceUsageStats->total()));
     spdlog::info("stone_skipper task server has stopped");
     return 0;
 }
 
+std::optional<int> readReplacedInstancePid(const CommandLine& commandLine)
+{
+    if (!commandLine.upgrade)
+        return std::nullopt;
+
+    if (!std::holds_alternative<UnixDomainHost>(commandLine.fcgiAddress))
+        throw Error{"Upgrade of the running instance is supported only for Unix domain sockets"};
+    if (!commandLine.pidFile.has_value())
+        throw Error{"Upgrade of the running instance requires the pid file path"};
+
+    const auto& pidFile = commandLine.pidFile.value();
+    const auto runningInstancePid = readInstancePid(pidFile);
+    if (!runningInstancePid.has_value())
+        throw Error{fmt::format("Couldn't read the pid of the running instance from {}", sfun::path_string(pidFile))};
+    return runningInstancePid;
+}
+
+void completeStartup(const CommandLine& commandLine, std::optional<int> replacedInstancePid)
+{
+    try {
+        if (commandLine.pidFile.has_value())
+            writeInstancePid(commandLine.pidFile.value());
+        if (replacedInstancePid.has_value())
+            requestInstanceDrain(replacedInstancePid.value());
+    }
+    catch (const Error& error) {
+        spdlog::error("Couldn't complete the startup: {}", error.what());
+    }
+}
+
+int mainApp(const CommandLine& commandLine)
+{
+    createDefaultConfig();
+    if (commandLine.log.has_value())
+        createDefaultLogger(commandLine.log.value());
+
+    auto configReader = figcone::ConfigReader{};
+    auto config = configReader.readShoalFile<Config>(commandLine.config);
+    spdlog::info("Configuration was read from {}", sfun::path_string(commandLine.config));
+
+    auto scheduler = TaskScheduler{commandLine.maxProcesses, config.priorityClasses};
+    for (const auto& taskCfg : config.tasks)
+        if (!taskCfg.priority.empty() && !scheduler.hasPriorityClass(taskCfg.priority))
+            throw Error{fmt::format("Task '{}' has an unknown priority class '{}'", taskCfg.route, taskCfg.priority)};
+    for (const auto& taskCfg : config.tasks)
+        if (taskCfg.artifact && !commandLine.artifactDir.has_value())
+            throw Error{fmt::format(
+                    "Task '{}' produces an artifact, but the artifact directory isn't set",
+                    taskCfg.route)};
+    const auto tasks = makeTasks(config.tasks, commandLine.shell);
+    if (commandLine.jobBufferSize > 0)
+        for (const auto& task : tasks)
+            if (matchesRoute(*task, jobPath(1, commandLine.workers)))
+                throw Error{fmt::format("Task route '{}' conflicts with the job output route /jobs/", task->route)};
+    for (const auto& task : tasks)
+        if (sfun::starts_with(task->route, batchRoutePrefix + "/"))
+            for (const auto& batchTask : tasks)
+                if (matchesBatchRoute(*batchTask, task->route))
+                    throw Error{fmt::format(
+                            "Task route '{}' conflicts with the batch route of the task '{}'",
+                            task->route,
+                            batchTask->route)};
+    if (config.tasks.empty())
+        spdlog::warn("No tasks were found in the config");
+    if (const auto tcpHost = std::get_if<TcpHost>(&commandLine.fcgiAddress);
+        tcpHost && tcpHost->port + commandLine.workers - 1 > std::numeric_limits<uint16_t>::max())
+        throw Error{fmt::format(
+                "Port numbers of {} workers starting from {} exceed {}",
+                commandLine.workers,
+                tcpHost->port,
+                std::numeric_limits<uint16_t>::max())};
+
+    const auto replacedInstancePid = readReplacedInstancePid(commandLine);
+    const auto onStarted = [&]
+    {
+        completeStartup(commandLine, replacedInstancePid);
+    };
+    if (commandLine.workers == 1)
+        return runServer(commandLine, tasks, scheduler, onStarted);
+
+    return runWorkers(
+            commandLine.workers,
+            [&](int workerIndex, const std::function<void()>& onListening)
+            {
+                return runServer(commandLine, tasks, scheduler, onListening, workerIndex);
+            },
+            onStarted);
+}
+
 int main(int argc, char** argv)
 {
     auto cmdLineReader = cmdlime::CommandLineReader<cmdlime::Format::Simple>{"stone_skipper", "v1.1.0"};
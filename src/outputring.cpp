@@ -0,0 +1,56 @@
+#include "outputring.h"
+#include <sfun/contract.h>
+#include <algorithm>
+
+namespace stone_skipper {
+
+OutputRing::OutputRing(std::size_t capacity)
+    : capacity_{capacity}
+{
+    sfun_contract_check(capacity_ > 0);
+}
+
+void OutputRing::write(std::string_view data)
+{
+    const auto appendedSize = std::min(capacity_ - buffer_.size(), data.size());
+    buffer_ += data.substr(0, appendedSize);
+    endOffset_ += appendedSize;
+    data.remove_prefix(appendedSize);
+
+    if (data.size() > capacity_) {
+        endOffset_ += data.size() - capacity_;
+        data.remove_prefix(data.size() - capacity_);
+    }
+    while (!data.empty()) {
+        const auto position = endOffset_ % capacity_;
+        const auto partSize = std::min(capacity_ - position, data.size());
+        buffer_.replace(position, partSize, data.substr(0, partSize));
+        endOffset_ += partSize;
+        data.remove_prefix(partSize);
+    }
+}
+
+OutputRingSlice OutputRing::read(std::size_t offset) const
+{
+    auto result = OutputRingSlice{};
+    result.offset = std::clamp(offset, beginOffset(), endOffset());
+    result.nextOffset = endOffset_;
+    result.data.reserve(result.nextOffset - result.offset);
+    const auto position = result.offset % capacity_;
+    const auto firstPartSize = std::min(buffer_.size() - position, result.nextOffset - result.offset);
+    result.data.append(buffer_, position, firstPartSize);
+    result.data.append(buffer_, 0, result.nextOffset - result.offset - firstPartSize);
+    return result;
+}
+
+std::size_t OutputRing::beginOffset() const
+{
+    return endOffset_ - buffer_.size();
+}
+
+std::size_t OutputRing::endOffset() const
+{
+    return endOffset_;
+}
+
+} //namespace stone_skipper
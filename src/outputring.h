@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace stone_skipper {
+
+struct OutputRingSlice {
+    std::string data;
+    std::size_t offset = 0;
+    std::size_t nextOffset = 0;
+};
+
+class OutputRing {
+public:
+    explicit OutputRing(std::size_t capacity);
+    void write(std::string_view data);
+    OutputRingSlice read(std::size_t offset) const;
+    std::size_t beginOffset() const;
+    std::size_t endOffset() const;
+
+private:
+    std::size_t capacity_;
+    std::string buffer_;
+    std::size_t endOffset_ = 0;
+};
+
+} //namespace stone_skipper
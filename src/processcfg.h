@@ -0,0 +1,143 @@
+#pragma once
+#include "processplacement.h"
+#include <fmt/format.h>
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace stone_skipper {
+
+struct ProcessEnvironment {
+    std::shared_ptr<const std::vector<std::string>> variables;
+    std::vector<std::pair<std::size_t, std::string>> parametrizedVariables;
+    // null-terminated array of pointers to the strings of 'variables'
+    std::shared_ptr<const std::vector<char*>> block;
+};
+
+struct ProcessCfg {
+    std::string command;
+    std::vector<std::string> params;
+    std::shared_ptr<const std::vector<std::string>> shellCommand;
+    std::optional<std::filesystem::path> workingDir;
+    std::optional<ProcessEnvironment> environment;
+    std::shared_ptr<const ProcessPlacement> placement;
+    std::optional<std::filesystem::path> outputFile;
+};
+
+class ProcessCfgParametrizationError : public std::runtime_error {
+public:
+    explicit ProcessCfgParametrizationError(std::string param)
+        : std::runtime_error{"ProcessCfgParametrizationError"}
+        , param_{std::move(param)}
+    {
+    }
+
+    std::string message(std::string_view command) const
+    {
+        return fmt::format(
+                "Couldn't launch the command '{}'. Request doesn't contain a parameter '{}'",
+                command,
+                param_);
+    }
+
+private:
+    std::string param_;
+};
+
+namespace detail {
+
+template<typename TTextHandler, typename TParamHandler>
+void forEachTemplatePart(std::string_view text, const TTextHandler& textHandler, const TParamHandler& paramHandler)
+{
+    while (!text.empty()) {
+        const auto paramBegin = text.find("{{");
+        const auto paramEnd = paramBegin == std::string_view::npos ? paramBegin : text.find("}}", paramBegin + 3);
+        if (paramEnd == std::string_view::npos) {
+            textHandler(text);
+            return;
+        }
+        textHandler(text.substr(0, paramBegin));
+        paramHandler(text.substr(paramBegin, paramEnd + 2 - paramBegin));
+        text.remove_prefix(paramEnd + 2);
+    }
+}
+
+template<typename TParamValueGetter>
+std::string expandParams(
+        std::string_view text,
+        const std::vector<std::string>& params,
+        const TParamValueGetter& paramValue)
+{
+    const auto placeholderValue = [&](std::string_view placeholder) -> std::optional<std::string_view>
+    {
+        const auto param = placeholder.substr(2, placeholder.size() - 4);
+        if (std::ranges::find(params, param) == params.end())
+            return std::nullopt;
+        auto value = paramValue(param);
+        if (!value.has_value())
+            throw ProcessCfgParametrizationError{std::string{param}};
+        return value;
+    };
+
+    auto size = std::size_t{};
+    forEachTemplatePart(
+            text,
+            [&](std::string_view textPart)
+            {
+                size += textPart.size();
+            },
+            [&](std::string_view placeholder)
+            {
+                size += placeholderValue(placeholder).value_or(placeholder).size();
+            });
+
+    auto result = std::string{};
+    result.reserve(size);
+    forEachTemplatePart(
+            text,
+            [&](std::string_view textPart)
+            {
+                result += textPart;
+            },
+            [&](std::string_view placeholder)
+            {
+                result += placeholderValue(placeholder).value_or(placeholder);
+            });
+    return result;
+}
+
+} //namespace detail
+
+template<typename TParamValueGetter>
+ProcessCfg makeProcessCfg(const ProcessCfg& templateProcessCfg, const TParamValueGetter& paramValue)
+{
+    auto processCfg = ProcessCfg{
+            .command = detail::expandParams(templateProcessCfg.command, templateProcessCfg.params, paramValue),
+            .params = {},
+            .shellCommand = templateProcessCfg.shellCommand,
+            .workingDir = templateProcessCfg.workingDir,
+            .environment = std::nullopt,
+            .placement = templateProcessCfg.placement,
+            .outputFile = std::nullopt};
+
+    if (templateProcessCfg.environment.has_value()) {
+        const auto& templateEnvironment = templateProcessCfg.environment.value();
+        auto& environment = processCfg.environment.emplace();
+        environment.variables = templateEnvironment.variables;
+        environment.block = templateEnvironment.block;
+        environment.parametrizedVariables.reserve(templateEnvironment.parametrizedVariables.size());
+        for (const auto& [index, variable] : templateEnvironment.parametrizedVariables)
+            environment.parametrizedVariables.emplace_back(
+                    index,
+                    detail::expandParams(variable, templateProcessCfg.params, paramValue));
+    }
+    return processCfg;
+}
+
+} //namespace stone_skipper
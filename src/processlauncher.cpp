@@ -1,14 +1,34 @@
 #include "processlauncher.h"
+#include "childreaper.h"
 #include "errors.h"
+#include "shellpool.h"
+#include "signalmaskreset.h"
 #include "utils.h"
 #include <fmt/format.h>
 #include <range/v3/range/conversion.hpp>
 #include <range/v3/view.hpp>
+#include <sfun/contract.h>
 #include <sfun/path.h>
 #include <sfun/string_utils.h>
 #include <boost/asio.hpp>
 #include <boost/process.hpp>
 #include <boost/process/extend.hpp>
+#ifdef _WIN32
+#include <boost/winapi/process.hpp>
+#else
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <iterator>
+#include <map>
+#include <memory>
 #include <string_view>
 #include <utility>
 #include <vector>
@@ -21,7 +41,7 @@ namespace stone_skipper {
 
 namespace {
 
-auto osArgs(const std::vector<std::string>& args)
+auto osArgs(std::vector<std::string> args)
 {
 #ifndef _WIN32
     return args;
@@ -34,121 +54,343 @@ auto osArgs(const std::vector<std::string>& args)
 #endif
 }
 
-std::string readBuffer(boost::asio::streambuf& streambuf, sfun::ssize_t size)
-{
-    return {buffers_begin(streambuf.data()), buffers_begin(streambuf.data()) + size};
-}
+class EnvironmentBlock : public proc::extend::handler {
+public:
+    explicit EnvironmentBlock(const std::optional<ProcessEnvironment>& environment)
+    {
+        if (!environment.has_value())
+            return;
+#ifndef _WIN32
+        sharedBlock_ = environment->block.get();
+        if (environment->parametrizedVariables.empty())
+            return;
+        block_ = *sharedBlock_;
+        for (const auto& [index, variable] : environment->parametrizedVariables)
+            block_.at(index) = const_cast<char*>(variable.c_str());
+#else
+        auto parametrizedVariable = environment->parametrizedVariables.begin();
+        for (auto index = std::size_t{}; index < environment->variables->size(); ++index) {
+            const auto isParametrized = parametrizedVariable != environment->parametrizedVariables.end() &&
+                    parametrizedVariable->first == index;
+            const auto& variable =
+                    isParametrized ? (parametrizedVariable++)->second : environment->variables->at(index);
+            block_ += sfun::to_wstring(variable);
+            block_.push_back(L'\0');
+        }
+        block_.push_back(L'\0');
+#endif
+    }
+
+    template<typename Executor>
+    void on_setup(Executor& exec)
+    {
+#ifndef _WIN32
+        if (!sharedBlock_)
+            return;
+        exec.env = block_.empty() ? const_cast<char**>(sharedBlock_->data()) : block_.data();
+#else
+        if (block_.empty())
+            return;
+        exec.env = block_.data();
+        exec.creation_flags |= ::boost::winapi::CREATE_UNICODE_ENVIRONMENT_;
+#endif
+    }
+
+private:
+#ifndef _WIN32
+    const std::vector<char*>* sharedBlock_ = nullptr;
+    std::vector<char*> block_;
+#else
+    std::wstring block_;
+#endif
+};
+
+#ifndef _WIN32
+class PlacementSetup : public proc::extend::handler {
+public:
+    explicit PlacementSetup(const ProcessPlacement* placement)
+        : placement_{placement}
+    {
+    }
+
+    template<typename Executor>
+    void on_exec_setup(Executor&) const
+    {
+        if (!placement_)
+            return;
+        if (const auto error = applyProcessPlacement(*placement_)) {
+            auto message = std::array<char, 64>{};
+            const auto prefix = std::string_view{"Couldn't apply the process placement, error code: "};
+            auto messageEnd = std::copy(prefix.begin(), prefix.end(), message.begin());
+            messageEnd = std::to_chars(messageEnd, message.end() - 1, error).ptr;
+            *messageEnd++ = '\n';
+            [[maybe_unused]] const auto result = write(STDERR_FILENO, message.data(), messageEnd - message.data());
+            _exit(EXIT_FAILURE);
+        }
+    }
+
+private:
+    const ProcessPlacement* placement_;
+};
+#endif
 
 class Process : public std::enable_shared_from_this<Process> {
+    struct PrivateTag {};
+
 public:
-    static void launch(
+    static std::shared_ptr<ProcessOutput> launch(
             boost::asio::io_context& io,
             const boost::filesystem::path& cmd,
-            const std::vector<std::string>& cmdArgs,
+            std::vector<std::string> cmdArgs,
             const boost::filesystem::path& workingDir,
-            const std::function<void(const ProcessResult&)>& resultHandler)
+            const std::optional<ProcessEnvironment>& environment,
+            const ProcessPlacement* placement,
+            const std::optional<fs::path>& outputFile,
+            const RequestTrace& trace)
     {
-        auto process =std::shared_ptr<Process>{new Process{io}};
-        process->launch(cmd, cmdArgs, workingDir, resultHandler);
+        auto process = std::make_shared<Process>(PrivateTag{}, io, trace);
+        process->launch(cmd, std::move(cmdArgs), workingDir, environment, placement, outputFile);
+        return process->output_;
     }
 
-private:
-    explicit Process(boost::asio::io_context& io)
+#ifndef _WIN32
+    static std::shared_ptr<ProcessOutput> launch(
+            boost::asio::io_context& io,
+            PooledShell shell,
+            std::int64_t spawnBeginTime,
+            const RequestTrace& trace)
+    {
+        auto process =
+                std::make_shared<Process>(PrivateTag{}, io, std::move(shell.output), std::move(shell.errorOutput), trace);
+        process->launch(shell.pid, spawnBeginTime);
+        return process->output_;
+    }
+#endif
+
+    Process(PrivateTag, boost::asio::io_context& io, const RequestTrace& trace)
         : io_{io}
-        , stdOutPipe_{io}
-        , stdErrPipe_{io}
+        , trace_{trace}
+        , stdOutPipe_{std::make_unique<boost::process::async_pipe>(io)}
+        , stdErrPipe_{std::make_unique<boost::process::async_pipe>(io)}
+#ifndef _WIN32
+        , childReaper_{boost::asio::use_service<ChildReaper>(io)}
+#endif
     {
     }
 
+#ifndef _WIN32
+    Process(PrivateTag,
+            boost::asio::io_context& io,
+            std::unique_ptr<boost::process::async_pipe> stdOutPipe,
+            std::unique_ptr<boost::process::async_pipe> stdErrPipe,
+            const RequestTrace& trace)
+        : io_{io}
+        , trace_{trace}
+        , stdOutPipe_{std::move(stdOutPipe)}
+        , stdErrPipe_{std::move(stdErrPipe)}
+        , childReaper_{boost::asio::use_service<ChildReaper>(io)}
+    {
+    }
+#endif
+
+private:
     void launch(
             const boost::filesystem::path& cmd,
-            const std::vector<std::string>& cmdArgs,
+            std::vector<std::string> cmdArgs,
+            const boost::filesystem::path& workingDir,
+            const std::optional<ProcessEnvironment>& environment,
+            const ProcessPlacement* placement,
+            const std::optional<fs::path>& outputFile)
+    {
+        const auto spawnBeginTime = trace_.now();
+        if (outputFile.has_value())
+            spawn(
+                    cmd,
+                    std::move(cmdArgs),
+                    workingDir,
+                    environment,
+                    placement,
+                    proc::std_out > boost::filesystem::path{outputFile.value().native()});
+        else
+            spawn(cmd, std::move(cmdArgs), workingDir, environment, placement, proc::std_out > *stdOutPipe_);
+        trace_.record("spawn", spawnBeginTime);
+        runBeginTime_ = trace_.now();
+
+        if (outputFile.has_value())
+            onOperationFinished();
+        else
+            readOutput(*stdOutPipe_, stdOutBuffer_, OutputSource::Output);
+        readOutput(*stdErrPipe_, stdErrBuffer_, OutputSource::ErrorOutput);
+    }
+
+    template<typename TStdOutRedirect>
+    void spawn(
+            const boost::filesystem::path& cmd,
+            std::vector<std::string> cmdArgs,
             const boost::filesystem::path& workingDir,
-            const std::function<void(const ProcessResult&)>& resultHandler)
+            const std::optional<ProcessEnvironment>& environment,
+            [[maybe_unused]] const ProcessPlacement* placement,
+            TStdOutRedirect&& stdOutRedirect)
     {
+#ifndef _WIN32
+        auto child = proc::child{
+                cmd,
+                proc::args(osArgs(std::move(cmdArgs))),
+                proc::start_dir = workingDir,
+                EnvironmentBlock{environment},
+                std::forward<TStdOutRedirect>(stdOutRedirect),
+                proc::std_err > *stdErrPipe_,
+                SignalMaskReset{},
+                PlacementSetup{placement}};
+        childPid_ = child.id();
+        child.detach();
+        waitForChildExit();
+#else
         proc::async_system(
                 io_,
-                [self = shared_from_this(), resultHandler](const boost::system::error_code& ec, int exitCode)
+                [self = shared_from_this()](const boost::system::error_code& ec, int exitCode)
                 {
-                    self->onExit(ec, exitCode, resultHandler);
+                    self->onExit(ec, exitCode);
                 },
                 cmd,
-                proc::args(osArgs(cmdArgs)),
+                proc::args(osArgs(std::move(cmdArgs))),
                 proc::start_dir = workingDir,
-                proc::std_out > stdOutPipe_,
-                proc::std_err > stdErrPipe_);
+                EnvironmentBlock{environment},
+                std::forward<TStdOutRedirect>(stdOutRedirect),
+                proc::std_err > *stdErrPipe_);
+#endif
+    }
+
+#ifndef _WIN32
+    void launch(int pid, std::int64_t spawnBeginTime)
+    {
+        childPid_ = pid;
+        waitForChildExit();
+        trace_.record("spawn", spawnBeginTime);
+        runBeginTime_ = trace_.now();
 
-        readOutput<&Process::stdOut_, &Process::stdOutBuffer_, &Process::stdOutPipe_>();
-        readOutput<&Process::stdErr_, &Process::stdErrBuffer_, &Process::stdErrPipe_>();
+        readOutput(*stdOutPipe_, stdOutBuffer_, OutputSource::Output);
+        readOutput(*stdErrPipe_, stdErrBuffer_, OutputSource::ErrorOutput);
     }
+#endif
 
-    void onExit(const std::error_code& ec, int exitCode, const std::function<void(const ProcessResult&)>& resultHandler)
+    void onExit(const std::error_code& ec, int exitCode)
     {
-        if (ec) {
-            resultHandler({.exitCode = exitCode, .output = stdOut_ + "\n" + ec.message(), .errorOutput = stdErr_});
-            return;
-        }
-        resultHandler({.exitCode = exitCode, .output = stdOut_, .errorOutput = stdErr_});
+        trace_.record("process", runBeginTime_);
+        result_.exitCode = exitCode;
+        if (ec)
+            exitErrorMessage_ = ec.message();
+        onOperationFinished();
     }
 
-    template<auto outputStringPtr, auto outputBufferPtr, auto outputPipePtr>
-    void readOutput()
+#ifndef _WIN32
+    void waitForChildExit()
     {
-        auto& outBuffer = this->*outputBufferPtr;
-        auto& outPipe = this->*outputPipePtr;
+        childReaper_.watch(
+                childPid_,
+                [self = shared_from_this()](int status, const ResourceUsage& resourceUsage)
+                {
+                    self->onChildExit(status, resourceUsage);
+                });
+    }
 
-        boost::asio::async_read_until(
-                outPipe,
-                outBuffer,
-                '\n',
-                [self = shared_from_this()](const boost::system::error_code& ec, std::size_t bytesTransferred)
+    void onChildExit(int status, const ResourceUsage& resourceUsage)
+    {
+        result_.resourceUsage = resourceUsage;
+        if (WIFEXITED(status))
+            onExit({}, WEXITSTATUS(status));
+        else if (WIFSIGNALED(status))
+            onExit({}, WTERMSIG(status));
+        else
+            onExit({}, status);
+    }
+#endif
+
+    void readOutput(boost::process::async_pipe& pipe, std::array<char, 4096>& buffer, OutputSource source)
+    {
+        pipe.async_read_some(
+                boost::asio::buffer(buffer),
+                [self = shared_from_this(), &pipe, &buffer, source](
+                        const boost::system::error_code& ec,
+                        std::size_t bytesTransferred)
                 {
-                    self->readOutput<outputStringPtr, outputBufferPtr, outputPipePtr>(ec, bytesTransferred);
+                    if (bytesTransferred > 0)
+                        self->output_->addChunk(source, std::string_view{buffer.data(), bytesTransferred});
+                    if (ec) {
+                        self->onOperationFinished();
+                        return;
+                    }
+                    self->readOutput(pipe, buffer, source);
                 });
     }
 
-    template<auto outputStringPtr, auto outputBufferPtr, auto outputPipePtr>
-    void readOutput(const boost::system::error_code& ec, std::size_t bytesTransferred)
+    void onOperationFinished()
     {
-        auto& outString = this->*outputStringPtr;
-        auto& outBuffer = this->*outputBufferPtr;
-        if (!ec) {
-            outString += readBuffer(outBuffer, bytesTransferred);
-            outBuffer.consume(bytesTransferred);
-            readOutput<outputStringPtr, outputBufferPtr, outputPipePtr>();
-        }
-        else if (ec == boost::asio::error::eof) {
-            outString += readBuffer(outBuffer, std::ssize(outBuffer));
-            outBuffer.consume(std::ssize(outBuffer));
-        }
+        if (pendingOperationsNumber_.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+        if (!exitErrorMessage_.empty())
+            output_->addChunk(OutputSource::Output, "\n" + exitErrorMessage_);
+        output_->finish(result_);
     }
 
     boost::asio::io_context& io_;
-    boost::process::async_pipe stdOutPipe_;
-    boost::process::async_pipe stdErrPipe_;
-    boost::asio::streambuf stdOutBuffer_;
-    boost::asio::streambuf stdErrBuffer_;
-    std::string stdOut_;
-    std::string stdErr_;
+    std::shared_ptr<ProcessOutput> output_ = std::make_shared<ProcessOutput>();
+    RequestTrace trace_;
+    std::int64_t runBeginTime_ = 0;
+    std::unique_ptr<boost::process::async_pipe> stdOutPipe_;
+    std::unique_ptr<boost::process::async_pipe> stdErrPipe_;
+    std::array<char, 4096> stdOutBuffer_;
+    std::array<char, 4096> stdErrBuffer_;
+    ProcessResult result_{};
+    std::string exitErrorMessage_;
+    std::atomic<int> pendingOperationsNumber_ = 3;
+#ifndef _WIN32
+    ChildReaper& childReaper_;
+    pid_t childPid_ = -1;
+#endif
 };
 
+const std::vector<boost::filesystem::path>& systemPath()
+{
+    static const auto path = boost::this_process::path();
+    return path;
+}
+
+boost::filesystem::path searchPath(const std::string& cmdName, const boost::filesystem::path& workingDir)
+{
+#ifndef _WIN32
+    thread_local auto candidatePath = std::string{};
+    const auto isExecutable = [](const std::string& path)
+    {
+        struct stat fileStat = {};
+        return stat(path.c_str(), &fileStat) == 0 && S_ISREG(fileStat.st_mode) && access(path.c_str(), X_OK) == 0;
+    };
+    for (const auto& dir : views::concat(systemPath(), views::single(workingDir))) {
+        candidatePath.assign(dir.native());
+        candidatePath += '/';
+        candidatePath += cmdName;
+        if (isExecutable(candidatePath))
+            return boost::filesystem::path{candidatePath};
+    }
+    return {};
+#else
+    const auto path = views::concat(systemPath(), views::single(workingDir)) | ranges::to<std::vector>();
+    return proc::search_path(cmdName, path);
+#endif
+}
+
 std::tuple<std::string, std::vector<std::string>> parseShellCommand(
-        const std::string& shellCommand,
+        const std::vector<std::string>& shellCommand,
         const std::string& command)
 {
-    if (shellCommand.find('\n') != std::string::npos)
-        throw Error{fmt::format("Can't launch a command with a newline character: {}", shellCommand)};
-
-    const auto shellCmdParts = splitCommand(shellCommand);
-    if (shellCmdParts.empty())
-        throw Error{"Can't launch the process with an empty command"};
     if (command.find('\n') != std::string::npos)
         throw Error{fmt::format("Can't launch a command with a newline character: {}", command)};
 
-    const auto& shellExec = shellCmdParts.front();
-    const auto shellArgs = shellCmdParts | views::drop(1);
-    const auto args = views::concat(shellArgs, views::single(command)) | ranges::to<std::vector>;
-    return std::tuple{shellExec, args};
+    auto args = std::vector<std::string>{};
+    args.reserve(shellCommand.size());
+    std::copy(std::next(shellCommand.begin()), shellCommand.end(), std::back_inserter(args));
+    args.push_back(command);
+    return std::tuple{shellCommand.front(), std::move(args)};
 }
 
 std::tuple<std::string, std::vector<std::string>> parseCommand(const std::string& command)
@@ -160,33 +402,188 @@ std::tuple<std::string, std::vector<std::string>> parseCommand(const std::string
     if (cmdParts.empty())
         throw Error{"Can't launch the process with an empty command"};
 
-    const auto& processExec = cmdParts.front();
-    const auto args = cmdParts | views::drop(1) | ranges::to<std::vector>;
-    return std::tuple{processExec, args};
+    auto processExec = std::move(cmdParts.front());
+    cmdParts.erase(cmdParts.begin());
+    return std::tuple{std::move(processExec), std::move(cmdParts)};
 }
 
 } //namespace
 
-void launchProcess(
+boost::asio::awaitable<std::span<OutputChunk>> ProcessOutput::nextChunks(std::vector<OutputChunk>& chunks)
+{
+    while (true) {
+        {
+            auto lock = std::scoped_lock{mutex_};
+            if (pendingChunksNumber_ > 0) {
+                std::swap(chunks, chunks_);
+                co_return std::span<OutputChunk>{chunks.data(), std::exchange(pendingChunksNumber_, 0)};
+            }
+            if (result_.has_value())
+                co_return std::span<OutputChunk>{};
+        }
+        co_await wait(false);
+    }
+}
+
+boost::asio::awaitable<void> ProcessOutput::finished()
+{
+    return wait(true);
+}
+
+boost::asio::awaitable<void> ProcessOutput::wait(bool isResultRequired)
+{
+    return boost::asio::async_initiate<const boost::asio::use_awaitable_t<>&, void()>(
+            [this, isResultRequired](auto handler)
+            {
+                auto sharedHandler = std::make_shared<decltype(handler)>(std::move(handler));
+                auto resume = [sharedHandler]
+                {
+                    const auto executor = boost::asio::get_associated_executor(*sharedHandler);
+                    boost::asio::post(executor, std::move(*sharedHandler));
+                };
+                auto lock = std::unique_lock{mutex_};
+                if (!result_.has_value() && (isResultRequired || pendingChunksNumber_ == 0)) {
+                    chunkWaiter_ = std::move(resume);
+                    isResultWaiter_ = isResultRequired;
+                    return;
+                }
+                lock.unlock();
+                resume();
+            },
+            boost::asio::use_awaitable);
+}
+
+ProcessResult ProcessOutput::result() const
+{
+    auto lock = std::scoped_lock{mutex_};
+    sfun_contract_check(result_.has_value());
+    return result_.value();
+}
+
+void ProcessOutput::addChunk(OutputSource source, std::string_view data)
+{
+    auto chunkWaiter = std::function<void()>{};
+    {
+        auto lock = std::scoped_lock{mutex_};
+        if (pendingChunksNumber_ > 0 && chunks_.at(pendingChunksNumber_ - 1).source == source)
+            chunks_.at(pendingChunksNumber_ - 1).data += data;
+        else {
+            if (pendingChunksNumber_ == chunks_.size())
+                chunks_.emplace_back();
+            auto& chunk = chunks_.at(pendingChunksNumber_++);
+            chunk.source = source;
+            chunk.data.assign(data);
+        }
+        if (!isResultWaiter_)
+            std::swap(chunkWaiter, chunkWaiter_);
+    }
+    if (chunkWaiter)
+        chunkWaiter();
+}
+
+void ProcessOutput::finish(const ProcessResult& result)
+{
+    auto chunkWaiter = std::function<void()>{};
+    {
+        auto lock = std::scoped_lock{mutex_};
+        result_ = result;
+        std::swap(chunkWaiter, chunkWaiter_);
+    }
+    if (chunkWaiter)
+        chunkWaiter();
+}
+
+std::shared_ptr<ProcessOutput> launchProcess(
         boost::asio::io_context& io,
         const ProcessCfg& processCfg,
-        const std::function<void(const ProcessResult&)>& resultHandler)
+        const RequestTrace& trace,
+        [[maybe_unused]] ShellPool* shellPool)
 {
-    const auto [cmdName, cmdArgs] = processCfg.shellCommand.has_value()
-            ? parseShellCommand(processCfg.shellCommand.value(), processCfg.command)
+    auto [cmdName, cmdArgs] = processCfg.shellCommand
+            ? parseShellCommand(*processCfg.shellCommand, processCfg.command)
             : parseCommand(processCfg.command);
 
-    const auto currentPath = boost::this_process::path();
     const auto workingDir = processCfg.workingDir.has_value()
             ? boost::filesystem::path(processCfg.workingDir.value().native())
             : boost::filesystem::path{sfun::make_path(".").native()};
-    const auto path = views::concat(currentPath, views::single(workingDir)) | ranges::to<std::vector>();
 
-    const auto cmd = proc::search_path(std::string{cmdName}, path);
+#ifndef _WIN32
+    const auto canUseShellPool = processCfg.shellCommand && !processCfg.environment.has_value() &&
+            !processCfg.placement && !processCfg.outputFile.has_value();
+    if (shellPool && canUseShellPool && workingDir.string().find('\n') == std::string::npos) {
+        const auto spawnBeginTime = trace.now();
+        if (auto shell = shellPool->acquire(io, processCfg.command, workingDir.string()))
+            return Process::launch(io, std::move(shell.value()), spawnBeginTime, trace);
+    }
+#endif
+    const auto searchPathBeginTime = trace.now();
+    const auto cmd = searchPath(cmdName, workingDir);
+    trace.record("searchPath", searchPathBeginTime);
     if (cmd.empty())
         throw Error{fmt::format("Couldn't find the executable of the command '{}'", cmdName)};
 
-    Process::launch(io, cmd, cmdArgs, workingDir, resultHandler);
+    return Process::launch(
+            io,
+            cmd,
+            std::move(cmdArgs),
+            workingDir,
+            processCfg.environment,
+            processCfg.placement.get(),
+            processCfg.outputFile,
+            trace);
+}
+
+boost::asio::awaitable<ProcessResult> asyncLaunchProcess(
+        boost::asio::io_context& io,
+        const ProcessCfg& processCfg,
+        const RequestTrace& trace,
+        ShellPool* shellPool)
+{
+    const auto processOutput = launchProcess(io, processCfg, trace, shellPool);
+    co_await processOutput->finished();
+
+    auto result = processOutput->result();
+    auto chunks = std::vector<OutputChunk>{};
+    for (auto& chunk : co_await processOutput->nextChunks(chunks)) {
+        auto& output = chunk.source == OutputSource::Output ? result.output : result.errorOutput;
+        if (output.empty())
+            output = std::move(chunk.data);
+        else
+            output += chunk.data;
+    }
+    co_return result;
+}
+
+ProcessEnvironment makeProcessEnvironment(
+        const std::map<std::string, std::string>& variables,
+        bool clearInheritedVariables)
+{
+    auto environment = std::map<std::string, std::string>{};
+    if (!clearInheritedVariables)
+        for (const auto& variable : boost::this_process::environment())
+            environment[variable.get_name()] = variable.to_string();
+    for (const auto& [name, value] : variables)
+        environment[name] = value;
+
+    struct EnvironmentData {
+        std::vector<std::string> variables;
+        std::vector<char*> block;
+    };
+    auto data = std::make_shared<EnvironmentData>();
+    auto result = ProcessEnvironment{};
+    data->variables.reserve(environment.size());
+    for (const auto& [name, value] : environment) {
+        data->variables.emplace_back(name + "=" + value);
+        if (variables.contains(name) && value.find("{{") != std::string::npos)
+            result.parametrizedVariables.emplace_back(data->variables.size() - 1, data->variables.back());
+    }
+    data->block.reserve(data->variables.size() + 1);
+    for (auto& variable : data->variables)
+        data->block.push_back(variable.data());
+    data->block.push_back(nullptr);
+    result.variables = std::shared_ptr<const std::vector<std::string>>{data, &data->variables};
+    result.block = std::shared_ptr<const std::vector<char*>>{data, &data->block};
+    return result;
 }
 
 } //namespace stone_skipper
\ No newline at end of file
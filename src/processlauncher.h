@@ -1,8 +1,16 @@
 #pragma once
-#include <filesystem>
+#include "processcfg.h"
+#include "resourceusage.h"
+#include "tracer.h"
+#include <boost/asio/awaitable.hpp>
 #include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace boost::asio {
@@ -10,24 +18,59 @@ class io_context;
 }
 
 namespace stone_skipper {
-
-struct ProcessCfg {
-    std::string command;
-    std::vector<std::string> commandParams;
-    std::optional<std::string> shellCommand;
-    std::optional<std::filesystem::path> workingDir;
-};
+class ShellPool;
 
 struct ProcessResult {
     int exitCode;
     std::string output;
     std::string errorOutput;
+    std::optional<ResourceUsage> resourceUsage;
+};
+
+enum class OutputSource {
+    Output,
+    ErrorOutput
 };
 
-void launchProcess(
+struct OutputChunk {
+    OutputSource source;
+    std::string data;
+};
+
+class ProcessOutput {
+public:
+    boost::asio::awaitable<std::span<OutputChunk>> nextChunks(std::vector<OutputChunk>& chunks);
+    boost::asio::awaitable<void> finished();
+    ProcessResult result() const;
+
+    void addChunk(OutputSource, std::string_view data);
+    void finish(const ProcessResult&);
+
+private:
+    boost::asio::awaitable<void> wait(bool isResultRequired);
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<OutputChunk> chunks_;
+    std::size_t pendingChunksNumber_ = 0;
+    std::optional<ProcessResult> result_;
+    std::function<void()> chunkWaiter_;
+    bool isResultWaiter_ = false;
+};
+
+std::shared_ptr<ProcessOutput> launchProcess(
+        boost::asio::io_context&,
+        const ProcessCfg&,
+        const RequestTrace& trace = {},
+        ShellPool* shellPool = nullptr);
+boost::asio::awaitable<ProcessResult> asyncLaunchProcess(
         boost::asio::io_context&,
         const ProcessCfg&,
-        const std::function<void(const ProcessResult&)>& resultHandler);
+        const RequestTrace& trace = {},
+        ShellPool* shellPool = nullptr);
 void launchProcessDetached(const ProcessCfg&);
+ProcessEnvironment makeProcessEnvironment(
+        const std::map<std::string, std::string>& variables,
+        bool clearInheritedVariables);
 
 } //namespace stone_skipper
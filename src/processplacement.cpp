@@ -0,0 +1,142 @@
+#include "processplacement.h"
+#include "config.h"
+#include "errors.h"
+#include "utils.h"
+#include <fmt/format.h>
+#include <sfun/path.h>
+#ifdef __linux__
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace stone_skipper {
+
+namespace {
+
+#ifdef __linux__
+const auto cgroupRootPath = fs::path{"/sys/fs/cgroup"};
+
+int ioPriority(const std::string& ioniceClass, int ioniceLevel)
+{
+    const auto ioPriorityClassShift = 13;
+    if (ioniceClass == "realtime")
+        return (1 << ioPriorityClassShift) | ioniceLevel;
+    if (ioniceClass == "best-effort")
+        return (2 << ioPriorityClassShift) | ioniceLevel;
+    return 3 << ioPriorityClassShift;
+}
+
+void writeCgroupFile(const fs::path& path, const std::string& value)
+{
+    auto stream = std::ofstream{path};
+    stream << value << std::flush;
+    if (!stream)
+        throw Error{fmt::format("Couldn't write '{}' to {}", value, sfun::path_string(path))};
+}
+
+bool isCgroupControllerEnabled(const fs::path& subtreeControlPath, const std::string& controller)
+{
+    auto stream = std::ifstream{subtreeControlPath};
+    auto enabledController = std::string{};
+    while (stream >> enabledController)
+        if (enabledController == controller)
+            return true;
+    return false;
+}
+
+void enableCgroupController(const fs::path& cgroup, const std::string& controller)
+{
+    auto parentPath = cgroupRootPath;
+    for (const auto& part : cgroup) {
+        const auto subtreeControlPath = parentPath / "cgroup.subtree_control";
+        if (!isCgroupControllerEnabled(subtreeControlPath, controller))
+            writeCgroupFile(subtreeControlPath, "+" + controller);
+        parentPath /= part;
+    }
+}
+
+std::string createCgroup(const std::string& cgroupName, const std::string& cpuMax, const std::string& memoryMax)
+{
+    const auto cgroup = fs::path{cgroupName}.relative_path();
+    const auto cgroupPath = cgroupRootPath / cgroup;
+    auto error = std::error_code{};
+    fs::create_directories(cgroupPath, error);
+    if (error)
+        throw Error{fmt::format("Couldn't create the cgroup {}: {}", sfun::path_string(cgroupPath), error.message())};
+    if (!cpuMax.empty()) {
+        enableCgroupController(cgroup, "cpu");
+        writeCgroupFile(cgroupPath / "cpu.max", cpuMax);
+    }
+    if (!memoryMax.empty()) {
+        enableCgroupController(cgroup, "memory");
+        writeCgroupFile(cgroupPath / "memory.max", memoryMax);
+    }
+    return sfun::path_string(cgroupPath / "cgroup.procs");
+}
+#endif
+
+} //namespace
+
+std::shared_ptr<const ProcessPlacement> makeProcessPlacement(const TaskConfig& cfg)
+{
+    if (cfg.cpuAffinity.empty() && cfg.nice == 0 && cfg.ioniceClass.empty() && cfg.cgroup.empty())
+        return nullptr;
+
+#ifdef __linux__
+    auto placement = ProcessPlacement{};
+    if (!cfg.cpuAffinity.empty())
+        placement.cpuAffinity = parseCpuList(cfg.cpuAffinity, CPU_SETSIZE - 1);
+    placement.niceIncrement = cfg.nice;
+    if (!cfg.ioniceClass.empty())
+        placement.ioPriority = ioPriority(cfg.ioniceClass, cfg.ioniceLevel);
+    if (!cfg.cgroup.empty())
+        placement.cgroupProcsPath = createCgroup(cfg.cgroup, cfg.cpuMax, cfg.memoryMax);
+    return std::make_shared<const ProcessPlacement>(std::move(placement));
+#else
+    throw Error{"Process placement settings are supported only on Linux"};
+#endif
+}
+
+int applyProcessPlacement([[maybe_unused]] const ProcessPlacement& placement) noexcept
+{
+#ifdef __linux__
+    if (!placement.cgroupProcsPath.empty()) {
+        const auto cgroupProcsFile = open(placement.cgroupProcsPath.c_str(), O_WRONLY | O_CLOEXEC);
+        if (cgroupProcsFile < 0)
+            return errno;
+        const auto writeResult = write(cgroupProcsFile, "0", 1);
+        const auto writeError = errno;
+        close(cgroupProcsFile);
+        if (writeResult != 1)
+            return writeError;
+    }
+    if (!placement.cpuAffinity.empty()) {
+        auto cpuSet = cpu_set_t{};
+        CPU_ZERO(&cpuSet);
+        for (const auto cpu : placement.cpuAffinity)
+            CPU_SET(cpu, &cpuSet);
+        if (sched_setaffinity(0, sizeof(cpuSet), &cpuSet) != 0)
+            return errno;
+    }
+    if (placement.niceIncrement != 0) {
+        errno = 0;
+        if (nice(placement.niceIncrement) == -1 && errno != 0)
+            return errno;
+    }
+    if (placement.ioPriority.has_value()) {
+        const auto ioPriorityWhoProcess = 1;
+        if (syscall(SYS_ioprio_set, ioPriorityWhoProcess, 0, placement.ioPriority.value()) != 0)
+            return errno;
+    }
+#endif
+    return 0;
+}
+
+} //namespace stone_skipper
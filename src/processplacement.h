@@ -0,0 +1,21 @@
+#pragma once
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace stone_skipper {
+
+struct TaskConfig;
+
+struct ProcessPlacement {
+    std::vector<int> cpuAffinity;
+    int niceIncrement = 0;
+    std::optional<int> ioPriority;
+    std::string cgroupProcsPath;
+};
+
+std::shared_ptr<const ProcessPlacement> makeProcessPlacement(const TaskConfig& cfg);
+int applyProcessPlacement(const ProcessPlacement& placement) noexcept;
+
+} //namespace stone_skipper
@@ -0,0 +1,39 @@
+#include "requestcounter.h"
+
+namespace stone_skipper {
+
+RequestCounter::ActiveRequest::ActiveRequest(RequestCounter& counter)
+    : counter_{counter}
+{
+}
+
+RequestCounter::ActiveRequest::~ActiveRequest()
+{
+    auto lock = std::scoped_lock{counter_.mutex_};
+    --counter_.activeRequestsNumber_;
+}
+
+RequestCounter::RequestHandle RequestCounter::startRequest()
+{
+    {
+        auto lock = std::scoped_lock{mutex_};
+        if (!isAcceptingRequests_)
+            return nullptr;
+        ++activeRequestsNumber_;
+    }
+    return std::make_shared<const ActiveRequest>(*this);
+}
+
+void RequestCounter::stopAcceptingRequests()
+{
+    auto lock = std::scoped_lock{mutex_};
+    isAcceptingRequests_ = false;
+}
+
+int RequestCounter::activeRequestsNumber() const
+{
+    auto lock = std::scoped_lock{mutex_};
+    return activeRequestsNumber_;
+}
+
+} //namespace stone_skipper
@@ -0,0 +1,32 @@
+#pragma once
+#include <memory>
+#include <mutex>
+
+namespace stone_skipper {
+
+class RequestCounter {
+public:
+    class ActiveRequest {
+    public:
+        explicit ActiveRequest(RequestCounter&);
+        ~ActiveRequest();
+        ActiveRequest(const ActiveRequest&) = delete;
+        ActiveRequest& operator=(const ActiveRequest&) = delete;
+
+    private:
+        RequestCounter& counter_;
+    };
+    using RequestHandle = std::shared_ptr<const ActiveRequest>;
+
+    // returns nullptr after stopAcceptingRequests() was called
+    RequestHandle startRequest();
+    void stopAcceptingRequests();
+    int activeRequestsNumber() const;
+
+private:
+    mutable std::mutex mutex_;
+    int activeRequestsNumber_ = 0;
+    bool isAcceptingRequests_ = true;
+};
+
+} //namespace stone_skipper
@@ -0,0 +1,80 @@
+#include "resourceusage.h"
+#include <fmt/format.h>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+#include <algorithm>
+
+namespace stone_skipper {
+
+namespace {
+
+#ifndef _WIN32
+double seconds(const timeval& time)
+{
+    return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_usec) / 1'000'000;
+}
+#endif
+
+} //namespace
+
+ResourceUsage& ResourceUsage::operator+=(const ResourceUsage& other)
+{
+    userCpuTime += other.userCpuTime;
+    systemCpuTime += other.systemCpuTime;
+    maxResidentSetSize = std::max(maxResidentSetSize, other.maxResidentSetSize);
+    blockInputOperations += other.blockInputOperations;
+    blockOutputOperations += other.blockOutputOperations;
+    voluntaryContextSwitches += other.voluntaryContextSwitches;
+    involuntaryContextSwitches += other.involuntaryContextSwitches;
+    return *this;
+}
+
+#ifndef _WIN32
+ResourceUsage makeResourceUsage(const rusage& usage)
+{
+    return ResourceUsage{
+            .userCpuTime = seconds(usage.ru_utime),
+            .systemCpuTime = seconds(usage.ru_stime),
+            .maxResidentSetSize = usage.ru_maxrss,
+            .blockInputOperations = usage.ru_inblock,
+            .blockOutputOperations = usage.ru_oublock,
+            .voluntaryContextSwitches = usage.ru_nvcsw,
+            .involuntaryContextSwitches = usage.ru_nivcsw};
+}
+#endif
+
+std::string resourceUsageDescription(const ResourceUsage& usage)
+{
+    return fmt::format(
+            "CPU time: user {:.3f}s, system {:.3f}s, max RSS: {} KB, block IO: {} in, {} out, "
+            "context switches: {} voluntary, {} involuntary",
+            usage.userCpuTime,
+            usage.systemCpuTime,
+            usage.maxResidentSetSize,
+            usage.blockInputOperations,
+            usage.blockOutputOperations,
+            usage.voluntaryContextSwitches,
+            usage.involuntaryContextSwitches);
+}
+
+void ResourceUsageStats::add(const ResourceUsage& usage)
+{
+    auto lock = std::scoped_lock{mutex_};
+    ++processesNumber_;
+    total_ += usage;
+}
+
+int ResourceUsageStats::processesNumber() const
+{
+    auto lock = std::scoped_lock{mutex_};
+    return processesNumber_;
+}
+
+ResourceUsage ResourceUsageStats::total() const
+{
+    auto lock = std::scoped_lock{mutex_};
+    return total_;
+}
+
+} //namespace stone_skipper
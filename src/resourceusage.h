@@ -0,0 +1,40 @@
+#pragma once
+#include <mutex>
+#include <string>
+
+#ifndef _WIN32
+struct rusage;
+#endif
+
+namespace stone_skipper {
+
+struct ResourceUsage {
+    double userCpuTime = 0;
+    double systemCpuTime = 0;
+    long maxResidentSetSize = 0;
+    long blockInputOperations = 0;
+    long blockOutputOperations = 0;
+    long voluntaryContextSwitches = 0;
+    long involuntaryContextSwitches = 0;
+
+    ResourceUsage& operator+=(const ResourceUsage&);
+};
+
+#ifndef _WIN32
+ResourceUsage makeResourceUsage(const rusage&);
+#endif
+std::string resourceUsageDescription(const ResourceUsage&);
+
+class ResourceUsageStats {
+public:
+    void add(const ResourceUsage&);
+    int processesNumber() const;
+    ResourceUsage total() const;
+
+private:
+    mutable std::mutex mutex_;
+    int processesNumber_ = 0;
+    ResourceUsage total_;
+};
+
+} //namespace stone_skipper
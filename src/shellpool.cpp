@@ -0,0 +1,280 @@
+#include "shellpool.h"
+#include "childreaper.h"
+#include "errors.h"
+#include "signalmaskreset.h"
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include <boost/asio.hpp>
+#include <boost/process.hpp>
+#include <boost/process/extend.hpp>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <chrono>
+#include <utility>
+#include <vector>
+
+namespace proc = boost::process;
+
+namespace stone_skipper {
+
+namespace {
+const auto shellBootstrapScript = std::string{
+        "IFS= read -r STONE_SKIPPER_WORKING_DIR <&3 && IFS= read -r STONE_SKIPPER_COMMAND <&3 && exec 3<&- && "
+        "cd -- \"$STONE_SKIPPER_WORKING_DIR\" && eval \"$STONE_SKIPPER_COMMAND\""};
+
+#ifndef _WIN32
+class CommandInputSetup : public proc::extend::handler {
+public:
+    explicit CommandInputSetup(int inputFd)
+        : inputFd_{inputFd}
+    {
+    }
+
+    template<typename Executor>
+    void on_exec_setup(Executor&) const
+    {
+        const auto commandInputFd = 3;
+        if (inputFd_ == commandInputFd)
+            fcntl(inputFd_, F_SETFD, 0);
+        else
+            dup2(inputFd_, commandInputFd);
+    }
+
+private:
+    int inputFd_;
+};
+#endif
+} //namespace
+
+ShellPool::ShellPool(std::vector<std::string> shellCommand, int maxSize)
+    : shellCommand_{std::move(shellCommand)}
+    , maxSize_{maxSize}
+{
+#ifdef _WIN32
+    throw Error{"Shell pool isn't supported on Windows"};
+#endif
+    if (shellCommand_.empty())
+        throw Error{"Can't launch the process with an empty command"};
+#ifndef _WIN32
+    // a write to the input of an exited shell must fail with EPIPE instead of terminating the server
+    signal(SIGPIPE, SIG_IGN);
+#endif
+    thread_ = std::jthread{[this](std::stop_token stopToken)
+                           {
+                               refill(std::move(stopToken));
+                           }};
+}
+
+ShellPool::~ShellPool()
+{
+    thread_.request_stop();
+    if (thread_.joinable())
+        thread_.join();
+    for (auto& [io, idleShells] : idleShells_)
+        for (auto& shell : idleShells.shells)
+            retireShell(*io, shell);
+}
+
+std::optional<PooledShell> ShellPool::acquire(
+        boost::asio::io_context& io,
+        const std::string& command,
+        const std::string& workingDir)
+{
+    {
+        auto lock = std::scoped_lock{mutex_};
+        ++idleShells_[&io].acquisitionsNumber;
+    }
+    demandChanged_.notify_one();
+    for (auto shell = takeIdleShell(io); shell.has_value(); shell = takeIdleShell(io)) {
+        if (!hasExited(*shell) && passCommand(*shell, command, workingDir))
+            return shell;
+        retireShell(io, *shell);
+    }
+    return std::nullopt;
+}
+
+std::optional<PooledShell> ShellPool::takeIdleShell(boost::asio::io_context& io)
+{
+    auto lock = std::scoped_lock{mutex_};
+    auto& idleShells = idleShells_[&io];
+    if (idleShells.shells.empty())
+        return std::nullopt;
+    auto shell = std::move(idleShells.shells.front());
+    idleShells.shells.pop_front();
+    return shell;
+}
+
+int ShellPool::idleShellsNumber(boost::asio::io_context& io)
+{
+    auto lock = std::scoped_lock{mutex_};
+    const auto idleShellsIt = idleShells_.find(&io);
+    if (idleShellsIt == idleShells_.end())
+        return 0;
+    return static_cast<int>(idleShellsIt->second.shells.size());
+}
+
+int ShellPool::targetSize(const IdleShells& idleShells) const
+{
+    return std::clamp(std::max(idleShells.recentDemand, idleShells.acquisitionsNumber), 0, maxSize_);
+}
+
+boost::asio::io_context* ShellPool::findUnderfilledPool() const
+{
+    auto idleShellsNumber = std::ptrdiff_t{};
+    for (const auto& [io, idleShells] : idleShells_)
+        idleShellsNumber += std::ssize(idleShells.shells);
+    if (idleShellsNumber >= maxSize_)
+        return nullptr;
+
+    for (const auto& [io, idleShells] : idleShells_)
+        if (std::ssize(idleShells.shells) < targetSize(idleShells))
+            return io;
+    return nullptr;
+}
+
+void ShellPool::refill(std::stop_token stopToken)
+{
+    using namespace std::chrono_literals;
+    auto demandPeriodEnd = std::chrono::steady_clock::now() + 1s;
+    auto lock = std::unique_lock{mutex_};
+    while (!stopToken.stop_requested()) {
+        demandChanged_.wait_until(
+                lock,
+                stopToken,
+                demandPeriodEnd,
+                [this]
+                {
+                    return findUnderfilledPool() != nullptr;
+                });
+        if (stopToken.stop_requested())
+            return;
+
+        if (std::chrono::steady_clock::now() >= demandPeriodEnd) {
+            demandPeriodEnd = std::chrono::steady_clock::now() + 1s;
+            retireUnneededShells(lock);
+        }
+        const auto io = findUnderfilledPool();
+        if (!io)
+            continue;
+
+        lock.unlock();
+        try {
+            auto shell = startShell(*io);
+            lock.lock();
+            idleShells_[io].shells.push_back(std::move(shell));
+        }
+        catch (const std::exception& error) {
+            spdlog::error("Couldn't start a pooled shell: {}", error.what());
+            lock.lock();
+            demandChanged_.wait_until(
+                    lock,
+                    stopToken,
+                    demandPeriodEnd,
+                    []
+                    {
+                        return false;
+                    });
+        }
+    }
+}
+
+void ShellPool::retireUnneededShells(std::unique_lock<std::mutex>& lock)
+{
+    auto unneededShells = std::vector<std::pair<boost::asio::io_context*, PooledShell>>{};
+    for (auto& [io, idleShells] : idleShells_) {
+        idleShells.recentDemand = idleShells.acquisitionsNumber;
+        idleShells.acquisitionsNumber = 0;
+        for (auto it = idleShells.shells.begin(); it != idleShells.shells.end();) {
+            if (hasExited(*it)) {
+                unneededShells.emplace_back(io, std::move(*it));
+                it = idleShells.shells.erase(it);
+            }
+            else
+                ++it;
+        }
+        while (std::ssize(idleShells.shells) > targetSize(idleShells)) {
+            unneededShells.emplace_back(io, std::move(idleShells.shells.back()));
+            idleShells.shells.pop_back();
+        }
+    }
+    lock.unlock();
+    for (auto& [io, shell] : unneededShells)
+        retireShell(*io, shell);
+    lock.lock();
+}
+
+PooledShell ShellPool::startShell(boost::asio::io_context& io)
+{
+    auto shell = PooledShell{
+            .pid = -1,
+            .input = std::make_unique<proc::async_pipe>(io),
+            .output = std::make_unique<proc::async_pipe>(io),
+            .errorOutput = std::make_unique<proc::async_pipe>(io)};
+#ifndef _WIN32
+    for (const auto pipe : {shell.input.get(), shell.output.get(), shell.errorOutput.get()}) {
+        fcntl(pipe->native_source(), F_SETFD, FD_CLOEXEC);
+        fcntl(pipe->native_sink(), F_SETFD, FD_CLOEXEC);
+    }
+#endif
+    auto args = std::vector<std::string>{std::next(shellCommand_.begin()), shellCommand_.end()};
+    args.push_back(shellBootstrapScript);
+    const auto cmd = proc::search_path(shellCommand_.front());
+    if (cmd.empty())
+        throw Error{fmt::format("Couldn't find the executable of the command '{}'", shellCommand_.front())};
+
+#ifndef _WIN32
+    boost::asio::use_service<ChildReaper>(io);
+    auto child = proc::child{
+            cmd,
+            proc::args(std::move(args)),
+            proc::std_out > *shell.output,
+            proc::std_err > *shell.errorOutput,
+            SignalMaskReset{},
+            CommandInputSetup{shell.input->native_source()}};
+    shell.pid = child.id();
+    child.detach();
+    // with the shell holding the only read end, writing to the input of an exited shell fails with EPIPE
+    std::move(*shell.input).source(io).close();
+#endif
+    return shell;
+}
+
+bool ShellPool::hasExited([[maybe_unused]] const PooledShell& shell)
+{
+#ifndef _WIN32
+    return ChildReaper::hasExited(shell.pid);
+#else
+    return false;
+#endif
+}
+
+bool ShellPool::passCommand(PooledShell& shell, const std::string& command, const std::string& workingDir)
+{
+    auto shellInput = workingDir;
+    shellInput.push_back('\n');
+    shellInput += command;
+    shellInput.push_back('\n');
+    auto error = boost::system::error_code{};
+    boost::asio::write(*shell.input, boost::asio::buffer(shellInput), error);
+    if (error)
+        return false;
+    shell.input->close(error);
+    return true;
+}
+
+void ShellPool::retireShell([[maybe_unused]] boost::asio::io_context& io, [[maybe_unused]] PooledShell& shell)
+{
+#ifndef _WIN32
+    auto error = boost::system::error_code{};
+    shell.input->close(error);
+    shell.output->close(error);
+    shell.errorOutput->close(error);
+    boost::asio::use_service<ChildReaper>(io).watch(shell.pid, [](int, const ResourceUsage&) {});
+#endif
+}
+
+} //namespace stone_skipper
@@ -0,0 +1,66 @@
+#pragma once
+#include <boost/process/async_pipe.hpp>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace boost::asio {
+class io_context;
+}
+
+namespace stone_skipper {
+
+struct PooledShell {
+    int pid;
+    std::unique_ptr<boost::process::async_pipe> input;
+    std::unique_ptr<boost::process::async_pipe> output;
+    std::unique_ptr<boost::process::async_pipe> errorOutput;
+};
+
+class ShellPool {
+public:
+    ShellPool(std::vector<std::string> shellCommand, int maxSize);
+    ~ShellPool();
+    ShellPool(const ShellPool&) = delete;
+    ShellPool& operator=(const ShellPool&) = delete;
+
+    std::optional<PooledShell> acquire(
+            boost::asio::io_context&,
+            const std::string& command,
+            const std::string& workingDir);
+    int idleShellsNumber(boost::asio::io_context&);
+
+private:
+    struct IdleShells {
+        std::deque<PooledShell> shells;
+        int acquisitionsNumber = 0;
+        int recentDemand = 0;
+    };
+
+    std::optional<PooledShell> takeIdleShell(boost::asio::io_context&);
+    void refill(std::stop_token);
+    void retireUnneededShells(std::unique_lock<std::mutex>&);
+    boost::asio::io_context* findUnderfilledPool() const;
+    int targetSize(const IdleShells&) const;
+    PooledShell startShell(boost::asio::io_context&);
+    static bool hasExited(const PooledShell&);
+    static bool passCommand(PooledShell&, const std::string& command, const std::string& workingDir);
+    static void retireShell(boost::asio::io_context&, PooledShell&);
+
+private:
+    std::vector<std::string> shellCommand_;
+    int maxSize_;
+    std::mutex mutex_;
+    std::condition_variable_any demandChanged_;
+    std::map<boost::asio::io_context*, IdleShells> idleShells_;
+    std::jthread thread_;
+};
+
+} //namespace stone_skipper
@@ -0,0 +1,23 @@
+#pragma once
+#include <boost/process/extend.hpp>
+#ifndef _WIN32
+#include <signal.h>
+#endif
+
+namespace stone_skipper {
+
+class SignalMaskReset : public boost::process::extend::handler {
+public:
+#ifndef _WIN32
+    template<typename Executor>
+    void on_exec_setup(Executor&) const
+    {
+        auto signals = sigset_t{};
+        sigemptyset(&signals);
+        sigprocmask(SIG_SETMASK, &signals, nullptr);
+        signal(SIGPIPE, SIG_DFL);
+    }
+#endif
+};
+
+} //namespace stone_skipper
@@ -0,0 +1,297 @@
+#include "supervisor.h"
+#include "errors.h"
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <vector>
+
+namespace stone_skipper {
+
+#ifndef _WIN32
+namespace {
+
+struct WorkerState {
+    pid_t pid = -1;
+    std::chrono::steady_clock::time_point startTime;
+    std::optional<std::chrono::steady_clock::time_point> restartTime;
+    int restartsNumber = 0;
+    double userCpuTime = 0;
+    double systemCpuTime = 0;
+    long maxResidentSetSize = 0;
+};
+
+double seconds(const timeval& time)
+{
+    return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_usec) / 1'000'000;
+}
+
+std::string exitStatusDescription(int status)
+{
+    if (WIFEXITED(status))
+        return fmt::format("exited with code {}", WEXITSTATUS(status));
+    if (WIFSIGNALED(status))
+        return fmt::format("was terminated by signal {}", WTERMSIG(status));
+    return "has stopped";
+}
+
+sigset_t supervisorSignals()
+{
+    auto signals = sigset_t{};
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGCHLD);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGUSR2);
+    return signals;
+}
+
+std::array<int, 2> makeListeningPipe()
+{
+    auto listeningPipe = std::array<int, 2>{-1, -1};
+    if (pipe(listeningPipe.data()) != 0)
+        throw Error{fmt::format("Couldn't create the worker notification pipe: {}", std::strerror(errno))};
+    for (const auto fd : listeningPipe)
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    return listeningPipe;
+}
+
+bool waitForWorkersListening(int listeningPipe, int workersNumber, const sigset_t& signals)
+{
+    using namespace std::chrono_literals;
+    const auto timeout = 30s;
+    const auto pollInterval = 100ms;
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    auto listeningWorkersNumber = 0;
+    while (listeningWorkersNumber < workersNumber) {
+        if (std::chrono::steady_clock::now() >= deadline)
+            return false;
+        auto pollFd = pollfd{.fd = listeningPipe, .events = POLLIN, .revents = 0};
+        if (poll(&pollFd, 1, static_cast<int>(pollInterval.count())) > 0) {
+            auto notifications = std::array<char, 64>{};
+            const auto size = read(listeningPipe, notifications.data(), notifications.size());
+            if (size <= 0)
+                return false;
+            listeningWorkersNumber += static_cast<int>(size);
+            continue;
+        }
+        auto pendingSignals = sigset_t{};
+        sigpending(&pendingSignals);
+        for (auto signal = 1; signal < NSIG; ++signal)
+            if (sigismember(&signals, signal) == 1 && sigismember(&pendingSignals, signal) == 1)
+                return false;
+    }
+    return true;
+}
+
+std::optional<std::chrono::steady_clock::time_point> nextRestartTime(const std::vector<WorkerState>& workers)
+{
+    auto result = std::optional<std::chrono::steady_clock::time_point>{};
+    for (const auto& worker : workers)
+        if (worker.restartTime.has_value() && (!result.has_value() || *worker.restartTime < *result))
+            result = worker.restartTime;
+    return result;
+}
+
+int cancelRestarts(std::vector<WorkerState>& workers)
+{
+    auto cancelledRestartsNumber = 0;
+    for (auto& worker : workers)
+        if (worker.restartTime.has_value()) {
+            worker.restartTime.reset();
+            ++cancelledRestartsNumber;
+        }
+    return cancelledRestartsNumber;
+}
+
+std::optional<int> waitForSignal(
+        const sigset_t& signals,
+        const std::optional<std::chrono::steady_clock::time_point>& deadline)
+{
+    if (!deadline.has_value()) {
+        auto signal = 0;
+        if (sigwait(&signals, &signal) != 0)
+            return std::nullopt;
+        return signal;
+    }
+    const auto timeout = std::max(
+            std::chrono::steady_clock::duration::zero(),
+            *deadline - std::chrono::steady_clock::now());
+    const auto timeoutSeconds = std::chrono::floor<std::chrono::seconds>(timeout);
+    const auto timeoutSpec = timespec{
+            .tv_sec = static_cast<time_t>(timeoutSeconds.count()),
+            .tv_nsec = static_cast<long>(std::chrono::nanoseconds{timeout - timeoutSeconds}.count())};
+    const auto signal = sigtimedwait(&signals, nullptr, &timeoutSpec);
+    if (signal < 0)
+        return std::nullopt;
+    return signal;
+}
+
+void startWorker(
+        WorkerState& worker,
+        int workerIndex,
+        const WorkerMain& workerMain,
+        const sigset_t& signals,
+        int listeningPipe)
+{
+    const auto pid = fork();
+    if (pid < 0)
+        throw Error{fmt::format("Couldn't start the worker process #{}: {}", workerIndex, std::strerror(errno))};
+
+    if (pid == 0) {
+        auto workerSignals = signals;
+        sigdelset(&workerSignals, SIGUSR2);
+        sigprocmask(SIG_UNBLOCK, &workerSignals, nullptr);
+        auto exitCode = 1;
+        try {
+            exitCode = workerMain(
+                    workerIndex,
+                    [listeningPipe]
+                    {
+                        if (listeningPipe < 0)
+                            return;
+                        const auto notification = char{};
+                        [[maybe_unused]] const auto result = write(listeningPipe, &notification, 1);
+                    });
+        }
+        catch (const std::exception& error) {
+            spdlog::error("Worker #{} has failed: {}", workerIndex, error.what());
+        }
+        std::exit(exitCode);
+    }
+
+    worker.pid = pid;
+    worker.startTime = std::chrono::steady_clock::now();
+    spdlog::info("Worker #{} was started with pid {}", workerIndex, pid);
+}
+
+} //namespace
+
+int runWorkers(int workersNumber, const WorkerMain& workerMain, const std::function<void()>& onWorkersListening)
+{
+    using namespace std::chrono_literals;
+    const auto minWorkerUptime = 1s;
+
+    const auto signals = supervisorSignals();
+    sigprocmask(SIG_BLOCK, &signals, nullptr);
+
+    auto workers = std::vector<WorkerState>(static_cast<std::size_t>(workersNumber));
+    const auto listeningPipe = makeListeningPipe();
+    for (auto i = 0; i < workersNumber; ++i)
+        startWorker(workers.at(i), i, workerMain, signals, listeningPipe[1]);
+    spdlog::info("stone_skipper supervisor has started {} workers", workersNumber);
+    const auto areWorkersListening = waitForWorkersListening(listeningPipe[0], workersNumber, signals);
+    for (const auto fd : listeningPipe)
+        close(fd);
+    if (areWorkersListening)
+        onWorkersListening();
+    else
+        spdlog::error("Not all workers have started listening, the startup wasn't completed");
+
+    auto isStopping = false;
+    auto runningWorkersNumber = workersNumber;
+    while (runningWorkersNumber > 0) {
+        const auto signal = waitForSignal(signals, nextRestartTime(workers));
+        for (auto i = 0; i < workersNumber; ++i) {
+            auto& worker = workers.at(i);
+            if (!worker.restartTime.has_value() || *worker.restartTime > std::chrono::steady_clock::now())
+                continue;
+            worker.restartTime.reset();
+            startWorker(worker, i, workerMain, signals, -1);
+            ++worker.restartsNumber;
+        }
+        if (!signal.has_value())
+            continue;
+
+        if (*signal == SIGUSR2) {
+            spdlog::info("stone_skipper supervisor is draining the workers");
+            runningWorkersNumber -= cancelRestarts(workers);
+            for (const auto& worker : workers)
+                if (worker.pid > 0)
+                    kill(worker.pid, SIGUSR2);
+            continue;
+        }
+        if (*signal == SIGTERM || *signal == SIGINT) {
+            if (isStopping)
+                continue;
+            isStopping = true;
+            spdlog::info("stone_skipper supervisor is stopping the workers");
+            runningWorkersNumber -= cancelRestarts(workers);
+            for (const auto& worker : workers)
+                if (worker.pid > 0)
+                    kill(worker.pid, SIGTERM);
+            continue;
+        }
+
+        auto status = 0;
+        auto usage = rusage{};
+        for (auto pid = wait4(-1, &status, WNOHANG, &usage); pid > 0; pid = wait4(-1, &status, WNOHANG, &usage)) {
+            const auto workerIt = std::ranges::find(workers, pid, &WorkerState::pid);
+            if (workerIt == workers.end())
+                continue;
+            const auto workerIndex = static_cast<int>(std::distance(workers.begin(), workerIt));
+            auto& worker = *workerIt;
+            worker.pid = -1;
+            worker.userCpuTime += seconds(usage.ru_utime);
+            worker.systemCpuTime += seconds(usage.ru_stime);
+            worker.maxResidentSetSize = std::max(worker.maxResidentSetSize, usage.ru_maxrss);
+            --runningWorkersNumber;
+            spdlog::info(
+                    "Worker #{} (pid {}) {}, CPU time: user {:.3f}s, system {:.3f}s, max RSS: {} KB",
+                    workerIndex,
+                    pid,
+                    exitStatusDescription(status),
+                    seconds(usage.ru_utime),
+                    seconds(usage.ru_stime),
+                    usage.ru_maxrss);
+
+            const auto isDrained = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+            if (isStopping || isDrained)
+                continue;
+            ++runningWorkersNumber;
+            const auto now = std::chrono::steady_clock::now();
+            if (now - worker.startTime < minWorkerUptime) {
+                worker.restartTime = now + minWorkerUptime;
+                continue;
+            }
+            startWorker(worker, workerIndex, workerMain, signals, -1);
+            ++worker.restartsNumber;
+        }
+    }
+
+    for (auto i = 0; i < workersNumber; ++i) {
+        const auto& worker = workers.at(i);
+        spdlog::info(
+                "Worker #{} summary: restarts: {}, CPU time: user {:.3f}s, system {:.3f}s, max RSS: {} KB",
+                i,
+                worker.restartsNumber,
+                worker.userCpuTime,
+                worker.systemCpuTime,
+                worker.maxResidentSetSize);
+    }
+    return 0;
+}
+
+#else
+
+int runWorkers(int, const WorkerMain&, const std::function<void()>&)
+{
+    throw Error{"Running multiple worker processes isn't supported on Windows"};
+}
+
+#endif
+
+} //namespace stone_skipper
@@ -0,0 +1,10 @@
+#pragma once
+#include <functional>
+
+namespace stone_skipper {
+
+using WorkerMain = std::function<int(int workerIndex, const std::function<void()>& onListening)>;
+
+int runWorkers(int workersNumber, const WorkerMain& workerMain, const std::function<void()>& onWorkersListening);
+
+} //namespace stone_skipper
@@ -1,55 +1,157 @@
 #include "task.h"
 #include "config.h"
+#include "errors.h"
+#include "utils.h"
+#include <fmt/format.h>
+#include <algorithm>
+#include <exception>
+#include <memory>
 #include <regex>
+#include <string_view>
+#include <thread>
 
 namespace stone_skipper {
 
 namespace {
-asyncgi::rx readRouteRegex(std::string input)
+std::string withoutBrackets(std::string_view str)
 {
-    const auto paramRegex = std::regex(R"(\{\{.+\}\})");
-    return asyncgi::rx{std::regex_replace(input, paramRegex, "(.+)")};
+    return std::string{str.substr(2, str.size() - 4)};
 }
 
-std::string withoutBrackets(const std::string& str)
+std::string readRoutePattern(std::string_view input)
 {
-    return str.substr(2, str.size() - 4);
+    auto routeRegex = std::string{};
+    detail::forEachTemplatePart(
+            input,
+            [&](std::string_view textPart)
+            {
+                routeRegex += textPart;
+            },
+            [&](std::string_view)
+            {
+                routeRegex += "(.+)";
+            });
+    return routeRegex;
 }
 
-std::vector<std::string> readParams(std::string input)
+asyncgi::rx readRouteRegex(std::string_view input)
+{
+    return asyncgi::rx{readRoutePattern(input)};
+}
+
+std::vector<std::string> readParams(std::string_view input)
 {
-    const auto paramRegex = std::regex(R"(\{\{.+\}\})");
-    auto match = std::smatch{};
     auto params = std::vector<std::string>{};
-    while (std::regex_search(input, match, paramRegex)) {
-        params.emplace_back(withoutBrackets(match.str()));
-        input = match.suffix();
-    }
+    detail::forEachTemplatePart(
+            input,
+            [](std::string_view) {},
+            [&](std::string_view placeholder)
+            {
+                params.emplace_back(withoutBrackets(placeholder));
+            });
     return params;
 }
 
-ProcessCfg makeProcessCfg(const TaskConfig& cfg, const std::string& shellCmd)
+std::shared_ptr<const std::vector<std::string>> readShellCommand(const std::string& shellCmd)
+{
+    if (shellCmd.find('\n') != std::string::npos)
+        throw Error{fmt::format("Can't launch a command with a newline character: {}", shellCmd)};
+    auto shellCmdParts = splitCommand(shellCmd);
+    if (shellCmdParts.empty())
+        throw Error{"Can't launch the process with an empty command"};
+    return std::make_shared<const std::vector<std::string>>(std::move(shellCmdParts));
+}
+
+ProcessCfg makeProcessCfg(
+        const TaskConfig& cfg,
+        const std::shared_ptr<const std::vector<std::string>>& shellCommand)
 {
     auto result = ProcessCfg{};
     result.workingDir = cfg.workingDir;
     if (!cfg.command.empty()) {
         result.command = cfg.command;
-        result.shellCommand = shellCmd;
+        result.shellCommand = shellCommand;
     }
     else {
         result.command = cfg.process;
     }
-    result.commandParams = readParams(result.command);
+    result.params = readParams(result.command);
+    result.placement = makeProcessPlacement(cfg);
+    if (!cfg.env.empty() || cfg.clearEnv) {
+        result.environment = makeProcessEnvironment(cfg.env, cfg.clearEnv);
+        for (const auto& [name, value] : cfg.env)
+            for (auto& param : readParams(value))
+                if (std::ranges::find(result.params, param) == result.params.end())
+                    result.params.emplace_back(std::move(param));
+    }
     return result;
 }
 
 } //namespace
 
-Task::Task(const TaskConfig& cfg, const std::string& shellCmd)
-    : routeRegexp{readRouteRegex(cfg.route)}
+Task::Task(const TaskConfig& cfg, const std::shared_ptr<const std::vector<std::string>>& shellCommand)
+    : route{cfg.route}
+    , routeRegexp{readRouteRegex(cfg.route)}
+    , batchRouteRegexp{readRouteRegex(batchRoutePrefix + cfg.route)}
     , routeParams{readParams(cfg.route)}
-    , process{makeProcessCfg(cfg, shellCmd)}
+    , process{makeProcessCfg(cfg, shellCommand)}
+    , priority{cfg.priority}
+    , batchParallelism{cfg.batchParallelism}
+    , batchMaxItems{cfg.batchMaxItems}
+    , resourceUsageHeaders{cfg.resourceUsageHeaders}
+    , artifact{cfg.artifact}
+    , artifactExtension{cfg.artifactExtension}
+    , resourceUsageStats{std::make_unique<ResourceUsageStats>()}
+{
+}
+
+std::vector<std::shared_ptr<const Task>> makeTasks(const std::vector<TaskConfig>& taskConfigs, const std::string& shellCmd)
+{
+    const auto minTasksNumberPerThread = std::size_t{256};
+    const auto hasShellCommands = std::ranges::any_of(
+            taskConfigs,
+            [](const TaskConfig& cfg)
+            {
+                return !cfg.command.empty();
+            });
+    const auto shellCommand = hasShellCommands ? readShellCommand(shellCmd) : nullptr;
+
+    auto tasks = std::vector<std::shared_ptr<const Task>>(taskConfigs.size());
+    const auto threadsNumber = std::clamp<std::size_t>(
+            taskConfigs.size() / minTasksNumberPerThread,
+            1,
+            std::max(1u, std::thread::hardware_concurrency()));
+    auto errors = std::vector<std::exception_ptr>(threadsNumber);
+    {
+        auto threads = std::vector<std::jthread>{};
+        threads.reserve(threadsNumber);
+        for (auto threadIndex = std::size_t{}; threadIndex < threadsNumber; ++threadIndex)
+            threads.emplace_back(
+                    [&, threadIndex]
+                    {
+                        try {
+                            for (auto i = threadIndex; i < taskConfigs.size(); i += threadsNumber)
+                                tasks.at(i) = std::make_shared<const Task>(taskConfigs.at(i), shellCommand);
+                        }
+                        catch (...) {
+                            errors.at(threadIndex) = std::current_exception();
+                        }
+                    });
+    }
+    for (const auto& error : errors)
+        if (error)
+            std::rethrow_exception(error);
+    return tasks;
+}
+
+bool matchesRoute(const Task& task, const std::string& path)
+{
+    return std::regex_match(path, std::regex{readRoutePattern(task.route)});
+}
+
+bool matchesBatchRoute(const Task& task, const std::string& path)
 {
+    return std::regex_match(path, std::regex{readRoutePattern(batchRoutePrefix + task.route)});
 }
 
 } //namespace stone_skipper
\ No newline at end of file
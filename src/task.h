@@ -1,8 +1,9 @@
 #pragma once
 #include "processlauncher.h"
+#include "resourceusage.h"
 #include <asyncgi/asyncgi.h>
 #include <filesystem>
-#include <regex>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -10,11 +11,26 @@ namespace stone_skipper {
 
 struct TaskConfig;
 
+inline const auto batchRoutePrefix = std::string{"/batch"};
+
 struct Task {
-    explicit Task(const TaskConfig&, const std::string& shellCmd);
+    Task(const TaskConfig&, const std::shared_ptr<const std::vector<std::string>>& shellCommand);
+    std::string route;
     asyncgi::rx routeRegexp;
+    asyncgi::rx batchRouteRegexp;
     std::vector<std::string> routeParams;
     ProcessCfg process;
+    std::string priority;
+    int batchParallelism;
+    int batchMaxItems;
+    bool resourceUsageHeaders;
+    bool artifact;
+    std::string artifactExtension;
+    std::unique_ptr<ResourceUsageStats> resourceUsageStats;
 };
 
+std::vector<std::shared_ptr<const Task>> makeTasks(const std::vector<TaskConfig>&, const std::string& shellCmd);
+bool matchesRoute(const Task&, const std::string& path);
+bool matchesBatchRoute(const Task&, const std::string& path);
+
 } //namespace stone_skipper
\ No newline at end of file
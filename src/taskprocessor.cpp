@@ -1,4 +1,6 @@
 #include "taskprocessor.h"
+#include "artifactstore.h"
+#include "jobregistry.h"
 #include "processlauncher.h"
 #include <fmt/format.h>
 #include <sfun/contract.h>
@@ -6,90 +8,393 @@
 #include <sfun/string_utils.h>
 #include <sfun/utility.h>
 #include <spdlog/spdlog.h>
+#include <boost/asio.hpp>
+#include <algorithm>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <utility>
 #include <variant>
 
 namespace stone_skipper {
 template<TaskLaunchMode launchMode>
-TaskProcessor<launchMode>::TaskProcessor(Task task)
+TaskProcessor<launchMode>::TaskProcessor(
+        std::shared_ptr<const Task> task,
+        TaskScheduler& scheduler,
+        RequestCounter& requestCounter,
+        Tracer* tracer,
+        ShellPool* shellPool,
+        JobRegistry* jobRegistry,
+        ArtifactStore* artifactStore)
     : task_{std::move(task)}
+    , scheduler_{scheduler}
+    , requestCounter_{requestCounter}
+    , tracer_{tracer}
+    , shellPool_{shellPool}
+    , jobRegistry_{jobRegistry}
+    , artifactStore_{artifactStore}
 {
 }
 
 namespace {
 
-auto makeProcessHandler(const ProcessCfg& taskProcess, asyncgi::Response& response, const asyncgi::TaskContext& ctx)
+void logProcessResult(const std::string& command, const ProcessResult& result, const Task& task)
 {
-    return [taskProcess, response, ctx](const ProcessResult& result) mutable
-    {
-        if (result.exitCode == 0) {
-            spdlog::info("The command '{}' was completed succesfully", taskProcess.command);
-            response.send(asyncgi::http::ResponseStatus::_200_Ok, result.output);
-        }
-        else {
-            spdlog::info("The command '{}' exited with an error code {}", taskProcess.command, result.exitCode);
-            response.send(asyncgi::http::ResponseStatus::_200_Ok, result.output + "\n" + result.errorOutput);
-        }
-    };
+    const auto resourceUsage = result.resourceUsage.has_value()
+            ? ", " + resourceUsageDescription(result.resourceUsage.value())
+            : std::string{};
+    if (result.exitCode == 0)
+        spdlog::info("The command '{}' was completed succesfully{}", command, resourceUsage);
+    else
+        spdlog::info("The command '{}' exited with an error code {}{}", command, result.exitCode, resourceUsage);
+
+    if (result.resourceUsage.has_value())
+        task.resourceUsageStats->add(result.resourceUsage.value());
 }
 
-auto makeLogProcessHandler(const ProcessCfg& taskProcess)
+void addResourceUsageHeaders(asyncgi::http::Response& response, const ResourceUsage& usage)
 {
-    return [taskProcess](const ProcessResult& result) mutable
-    {
-        if (result.exitCode == 0) {
-            spdlog::info("The command '{}' was completed succesfully", taskProcess.command);
+    response.addHeader(asyncgi::http::Header{"X-Process-User-Time", fmt::format("{:.3f}", usage.userCpuTime)});
+    response.addHeader(asyncgi::http::Header{"X-Process-System-Time", fmt::format("{:.3f}", usage.systemCpuTime)});
+    response.addHeader(asyncgi::http::Header{"X-Process-Max-RSS", std::to_string(usage.maxResidentSetSize)});
+    response.addHeader(asyncgi::http::Header{"X-Process-Block-Input", std::to_string(usage.blockInputOperations)});
+    response.addHeader(asyncgi::http::Header{"X-Process-Block-Output", std::to_string(usage.blockOutputOperations)});
+    response.addHeader(asyncgi::http::Header{
+            "X-Process-Voluntary-Context-Switches",
+            std::to_string(usage.voluntaryContextSwitches)});
+    response.addHeader(asyncgi::http::Header{
+            "X-Process-Involuntary-Context-Switches",
+            std::to_string(usage.involuntaryContextSwitches)});
+}
+
+boost::asio::awaitable<void> runTask(
+        boost::asio::io_context& io,
+        ProcessCfg taskProcess,
+        const Task& task,
+        asyncgi::Response response,
+        TaskScheduler& scheduler,
+        ShellPool* shellPool,
+        ArtifactStore* artifactStore,
+        RequestTrace trace,
+        RequestCounter::RequestHandle activeRequest)
+{
+    auto artifact = std::optional<Artifact>{};
+    try {
+        if (task.artifact && artifactStore) {
+            artifact = artifactStore->makeArtifact(task.artifactExtension);
+            taskProcess.outputFile = artifact->partPath;
         }
-        else {
-            spdlog::info("The command '{}' exited with an error code {}", taskProcess.command, result.exitCode);
+    }
+    catch (const std::exception& err) {
+        spdlog::error("Couldn't create an artifact: {}", err.what());
+        response.send(asyncgi::http::ResponseStatus::_500_Internal_Server_Error, "Couldn't create an artifact");
+        scheduler.onTaskFinished();
+        co_return;
+    }
+    try {
+        const auto result = co_await asyncLaunchProcess(io, taskProcess, trace, shellPool);
+        const auto sendResponseBeginTime = trace.now();
+        logProcessResult(taskProcess.command, result, task);
+        auto httpResponse = asyncgi::http::Response{
+                asyncgi::http::ResponseStatus::_200_Ok,
+                result.exitCode == 0 ? result.output : result.output + "\n" + result.errorOutput};
+        if (task.resourceUsageHeaders && result.resourceUsage.has_value())
+            addResourceUsageHeaders(httpResponse, result.resourceUsage.value());
+        if (artifact.has_value() && result.exitCode == 0) {
+            artifactStore->commit(artifact.value());
+            httpResponse.addHeader(
+                    asyncgi::http::Header{artifactStore->headerName(), artifactStore->headerValue(artifact.value())});
         }
-    };
+        response.send(httpResponse);
+        trace.record("sendResponse", sendResponseBeginTime);
+    }
+    catch (const std::runtime_error& err) {
+        spdlog::error("{}", err.what());
+        response.send(asyncgi::http::ResponseStatus::_424_Failed_Dependency, std::string{err.what()});
+    }
+    if (artifact.has_value())
+        artifactStore->discard(artifact.value());
+    scheduler.onTaskFinished();
 }
 
-void processTaskLaunch(const ProcessCfg& taskProcess, asyncgi::Response& response)
+boost::asio::awaitable<void> runDetachedTask(
+        boost::asio::io_context& io,
+        ProcessCfg taskProcess,
+        const Task& task,
+        asyncgi::Response response,
+        TaskScheduler& scheduler,
+        ShellPool* shellPool,
+        JobRegistry* jobRegistry,
+        RequestTrace trace,
+        RequestCounter::RequestHandle activeRequest)
+{
+    auto processOutput = std::shared_ptr<ProcessOutput>{};
+    try {
+        processOutput = launchProcess(io, taskProcess, trace, shellPool);
+    }
+    catch (const std::runtime_error& err) {
+        spdlog::error("{}", err.what());
+        response.send(asyncgi::http::ResponseStatus::_424_Failed_Dependency, std::string{err.what()});
+        scheduler.onTaskFinished();
+        co_return;
+    }
+    const auto infoMessage = fmt::format("The command '{}' was launched and detached.", taskProcess.command);
+    spdlog::info(infoMessage);
+    auto httpResponse = asyncgi::http::Response{asyncgi::http::ResponseStatus::_200_Ok, infoMessage};
+    auto job = std::shared_ptr<JobOutput>{};
+    if (jobRegistry) {
+        auto [jobId, jobOutput] = jobRegistry->addJob();
+        job = std::move(jobOutput);
+        httpResponse.addHeader(asyncgi::http::Header{"X-Job-Id", std::to_string(jobId)});
+        httpResponse.addHeader(asyncgi::http::Header{"X-Job-Path", jobRegistry->jobPath(jobId)});
+    }
+    response.send(httpResponse);
+    activeRequest.reset();
+
+    auto chunks = std::vector<OutputChunk>{};
+    for (auto newChunks = co_await processOutput->nextChunks(chunks); !newChunks.empty();
+         newChunks = co_await processOutput->nextChunks(chunks))
+        if (job)
+            for (const auto& chunk : newChunks)
+                job->write(chunk.data);
+    const auto result = processOutput->result();
+    if (job)
+        job->finish(result.exitCode);
+    logProcessResult(taskProcess.command, result, task);
+    scheduler.onTaskFinished();
+}
+
+void processTaskLaunch(
+        ProcessCfg taskProcess,
+        const Task& task,
+        asyncgi::Response& response,
+        TaskScheduler& scheduler,
+        ShellPool* shellPool,
+        ArtifactStore* artifactStore,
+        const RequestTrace& trace,
+        RequestCounter::RequestHandle activeRequest)
 {
     spdlog::info("Launching the command '{}'", taskProcess.command);
 
     auto disp = asyncgi::AsioDispatcher{response};
     disp.postTask(
-            [taskProcess, response](const asyncgi::TaskContext& ctx) mutable
+            [taskProcess = std::move(taskProcess),
+             &task,
+             response,
+             &scheduler,
+             shellPool,
+             artifactStore,
+             trace,
+             activeRequest = std::move(activeRequest)](const asyncgi::TaskContext& ctx) mutable
             {
-                try {
-                    launchProcess(ctx.io(), taskProcess, makeProcessHandler(taskProcess, response, ctx));
-                }
-                catch (const std::runtime_error& err) {
-                    spdlog::error("{}", err.what());
-                    response.send(asyncgi::http::ResponseStatus::_424_Failed_Dependency, std::string{err.what()});
-                }
+                boost::asio::co_spawn(
+                        ctx.io(),
+                        runTask(
+                                ctx.io(),
+                                std::move(taskProcess),
+                                task,
+                                response,
+                                scheduler,
+                                shellPool,
+                                artifactStore,
+                                trace,
+                                std::move(activeRequest)),
+                        boost::asio::detached);
             });
 }
 
-void processTaskLaunchDetached(const ProcessCfg& taskProcess, asyncgi::Response& response)
+void processTaskLaunchDetached(
+        ProcessCfg taskProcess,
+        const Task& task,
+        asyncgi::Response& response,
+        TaskScheduler& scheduler,
+        ShellPool* shellPool,
+        JobRegistry* jobRegistry,
+        const RequestTrace& trace,
+        RequestCounter::RequestHandle activeRequest)
 {
     auto disp = asyncgi::AsioDispatcher{response};
     disp.postTask(
-            [taskProcess, response](const asyncgi::TaskContext& ctx) mutable
+            [taskProcess = std::move(taskProcess),
+             &task,
+             response,
+             &scheduler,
+             shellPool,
+             jobRegistry,
+             trace,
+             activeRequest = std::move(activeRequest)](const asyncgi::TaskContext& ctx) mutable
             {
-                try {
-                    launchProcess(ctx.io(), taskProcess, makeLogProcessHandler(taskProcess));
-                    const auto infoMessage = fmt::format("The command '{}' was launched and detached.",taskProcess.command);
-                    spdlog::info(infoMessage);
-                    response.send(infoMessage);
-                }
-                catch (const std::runtime_error& err) {
-                    spdlog::error("{}", err.what());
-                    response.send(asyncgi::http::ResponseStatus::_424_Failed_Dependency, std::string{err.what()});
-                }
+                boost::asio::co_spawn(
+                        ctx.io(),
+                        runDetachedTask(
+                                ctx.io(),
+                                std::move(taskProcess),
+                                task,
+                                response,
+                                scheduler,
+                                shellPool,
+                                jobRegistry,
+                                trace,
+                                std::move(activeRequest)),
+                        boost::asio::detached);
             });
 }
 
-std::optional<std::string> paramFromRoute(
-        const std::string& commandParamName,
+class BatchLaunch : public std::enable_shared_from_this<BatchLaunch> {
+    struct PrivateTag {};
+
+public:
+    static void launch(
+            std::vector<ProcessCfg> items,
+            const Task& task,
+            std::string priorityClass,
+            asyncgi::Response& response,
+            TaskScheduler& scheduler,
+            ShellPool* shellPool,
+            const RequestTrace& trace,
+            RequestCounter::RequestHandle activeRequest)
+    {
+        if (items.empty()) {
+            response.send(
+                    asyncgi::http::ResponseStatus::_422_Unprocessable_Entity,
+                    "Batch request doesn't contain any parameter sets");
+            return;
+        }
+        const auto itemsNumber = items.size();
+        auto batch = std::make_shared<BatchLaunch>(
+                PrivateTag{},
+                std::move(items),
+                task,
+                std::move(priorityClass),
+                response,
+                scheduler,
+                shellPool,
+                trace,
+                std::move(activeRequest));
+        batch->nextItemIndex_ = std::min(itemsNumber, static_cast<std::size_t>(task.batchParallelism));
+        for (auto i = std::size_t{}; i < batch->nextItemIndex_; ++i)
+            batch->launchItem(i);
+    }
+
+    BatchLaunch(
+            PrivateTag,
+            std::vector<ProcessCfg> items,
+            const Task& task,
+            std::string priorityClass,
+            asyncgi::Response& response,
+            TaskScheduler& scheduler,
+            ShellPool* shellPool,
+            const RequestTrace& trace,
+            RequestCounter::RequestHandle activeRequest)
+        : items_{std::move(items)}
+        , task_{task}
+        , priorityClass_{std::move(priorityClass)}
+        , response_{response}
+        , scheduler_{scheduler}
+        , shellPool_{shellPool}
+        , trace_{trace}
+        , activeRequest_{std::move(activeRequest)}
+    {
+    }
+
+private:
+    void launchItem(std::size_t itemIndex)
+    {
+        const auto scheduleBeginTime = trace_.now();
+        scheduler_.schedule(
+                priorityClass_,
+                [self = shared_from_this(), itemIndex, scheduleBeginTime]
+                {
+                    self->itemTrace(itemIndex).record("schedule", scheduleBeginTime);
+                    auto disp = asyncgi::AsioDispatcher{self->response_};
+                    disp.postTask(
+                            [self, itemIndex](const asyncgi::TaskContext& ctx)
+                            {
+                                boost::asio::co_spawn(
+                                        ctx.io(),
+                                        runItem(self, ctx.io(), itemIndex),
+                                        boost::asio::detached);
+                            });
+                });
+    }
+
+    static boost::asio::awaitable<void> runItem(
+            std::shared_ptr<BatchLaunch> self,
+            boost::asio::io_context& io,
+            std::size_t itemIndex)
+    {
+        const auto& itemProcess = self->items_.at(itemIndex);
+        const auto itemTrace = self->itemTrace(itemIndex);
+        const auto itemBeginTime = itemTrace.now();
+        spdlog::info("Launching the command '{}'", itemProcess.command);
+        auto itemHeader = std::string{};
+        auto itemOutput = std::string{};
+        try {
+            const auto result = co_await asyncLaunchProcess(io, itemProcess, itemTrace, self->shellPool_);
+            logProcessResult(itemProcess.command, result, self->task_);
+            itemHeader = fmt::format("[{}] exit code {}\n", itemIndex, result.exitCode);
+            itemOutput = result.exitCode == 0 ? result.output : result.output + "\n" + result.errorOutput;
+        }
+        catch (const std::runtime_error& err) {
+            spdlog::error("{}", err.what());
+            itemHeader = fmt::format("[{}] launch error\n", itemIndex);
+            itemOutput = err.what();
+        }
+        itemTrace.record("batchItem", itemBeginTime);
+        self->onItemFinished(itemHeader, itemOutput);
+        self->scheduler_.onTaskFinished();
+    }
+
+    RequestTrace itemTrace(std::size_t itemIndex) const
+    {
+        return trace_.batchItemTrace(static_cast<int>(itemIndex));
+    }
+
+    void onItemFinished(const std::string& itemHeader, const std::string& itemOutput)
+    {
+        auto nextItemIndex = std::optional<std::size_t>{};
+        auto isBatchFinished = false;
+        {
+            auto lock = std::scoped_lock{mutex_};
+            output_ += itemHeader;
+            output_ += itemOutput;
+            if (!itemOutput.empty() && itemOutput.back() != '\n')
+                output_ += '\n';
+            if (nextItemIndex_ < items_.size())
+                nextItemIndex = nextItemIndex_++;
+            isBatchFinished = ++finishedItemsNumber_ == items_.size();
+        }
+        if (nextItemIndex.has_value())
+            launchItem(nextItemIndex.value());
+        if (isBatchFinished) {
+            const auto sendResponseBeginTime = trace_.now();
+            response_.send(asyncgi::http::ResponseStatus::_200_Ok, output_);
+            trace_.record("sendResponse", sendResponseBeginTime);
+            activeRequest_.reset();
+        }
+    }
+
+private:
+    std::vector<ProcessCfg> items_;
+    const Task& task_;
+    std::string priorityClass_;
+    asyncgi::Response response_;
+    TaskScheduler& scheduler_;
+    ShellPool* shellPool_;
+    RequestTrace trace_;
+    RequestCounter::RequestHandle activeRequest_;
+    std::mutex mutex_;
+    std::size_t nextItemIndex_ = 0;
+    std::size_t finishedItemsNumber_ = 0;
+    std::string output_;
+};
+
+std::optional<std::string_view> paramFromRoute(
+        std::string_view paramName,
         const std::vector<std::string>& regexRouteParams,
-        asyncgi::RouteParameters<> routeParams)
+        const asyncgi::RouteParameters<>& routeParams)
 {
-    const auto it = std::ranges::find(regexRouteParams, commandParamName);
+    const auto it = std::ranges::find(regexRouteParams, paramName);
     if (it == regexRouteParams.end())
         return std::nullopt;
     const auto routeParamIndex = std::distance(regexRouteParams.begin(), it);
@@ -97,32 +402,23 @@ std::optional<std::string> paramFromRoute(
     return routeParams.value.at(routeParamIndex);
 }
 
-std::optional<std::string> paramFromQueries(const std::string& commandParamName, const asyncgi::Request& request)
+std::optional<std::string_view> paramFromQueries(std::string_view paramName, const asyncgi::Request& request)
 {
-    if (!request.hasQuery(commandParamName))
+    if (!request.hasQuery(paramName))
         return std::nullopt;
-    return std::string{request.query(commandParamName)};
+    return request.query(paramName);
 }
 
-class ProcessCfgParametrizationError : public std::runtime_error {
-public:
-    ProcessCfgParametrizationError(std::string param)
-        : std::runtime_error{"ProcessCfgParametrizationError"}
-        , param_{std::move(param)}
-    {
-    }
-
-    std::string message(std::string_view command) const
-    {
-        return fmt::format(
-                "Couldn't launch the command '{}'. Request doesn't contain a parameter '{}'",
-                command,
-                param_);
-    }
-
-private:
-    std::string param_;
-};
+std::optional<std::string_view> paramFromFormFields(
+        std::string_view paramName,
+        const asyncgi::Request& request,
+        int batchItemIndex)
+{
+    const auto valuesNumber = request.formFieldCount(paramName);
+    if (valuesNumber == 0)
+        return std::nullopt;
+    return request.formField(paramName, valuesNumber == 1 ? 0 : batchItemIndex);
+}
 
 ProcessCfg makeProcessCfg(
         const ProcessCfg& templateProcessCfg,
@@ -130,16 +426,64 @@ ProcessCfg makeProcessCfg(
         const asyncgi::RouteParameters<>& routeParams,
         const asyncgi::Request& request)
 {
-    auto processCfg = templateProcessCfg;
-    for (const auto& commandParam : processCfg.commandParams) {
-        if (auto routeParam = paramFromRoute(commandParam, regexRouteParams, routeParams))
-            processCfg.command = sfun::replace(processCfg.command, "{{" + commandParam + "}}", routeParam.value());
-        else if (auto queryParam = paramFromQueries(commandParam, request))
-            processCfg.command = sfun::replace(processCfg.command, "{{" + commandParam + "}}", queryParam.value());
-        else
-            throw ProcessCfgParametrizationError{commandParam};
+    return makeProcessCfg(
+            templateProcessCfg,
+            [&](std::string_view paramName)
+            {
+                auto paramValue = paramFromRoute(paramName, regexRouteParams, routeParams);
+                if (!paramValue)
+                    paramValue = paramFromQueries(paramName, request);
+                return paramValue;
+            });
+}
+
+int batchSize(const ProcessCfg& templateProcessCfg, const asyncgi::Request& request)
+{
+    auto result = 0;
+    for (const auto& param : templateProcessCfg.params)
+        result = std::max(result, request.formFieldCount(param));
+    return result;
+}
+
+std::optional<std::string> batchParamsError(
+        const ProcessCfg& templateProcessCfg,
+        int itemsNumber,
+        const asyncgi::Request& request)
+{
+    for (const auto& param : templateProcessCfg.params) {
+        const auto valuesNumber = request.formFieldCount(param);
+        if (valuesNumber > 1 && valuesNumber != itemsNumber)
+            return fmt::format(
+                    "Batch request parameter '{}' has {} values, it must have 1 or {} values",
+                    param,
+                    valuesNumber,
+                    itemsNumber);
     }
-    return processCfg;
+    return std::nullopt;
+}
+
+std::vector<ProcessCfg> makeBatchProcessCfgs(
+        const ProcessCfg& templateProcessCfg,
+        int itemsNumber,
+        const std::vector<std::string>& regexRouteParams,
+        const asyncgi::RouteParameters<>& routeParams,
+        const asyncgi::Request& request)
+{
+    auto result = std::vector<ProcessCfg>{};
+    result.reserve(static_cast<std::size_t>(itemsNumber));
+    for (auto itemIndex = 0; itemIndex < itemsNumber; ++itemIndex)
+        result.emplace_back(makeProcessCfg(
+                templateProcessCfg,
+                [&](std::string_view paramName)
+                {
+                    auto paramValue = paramFromRoute(paramName, regexRouteParams, routeParams);
+                    if (!paramValue)
+                        paramValue = paramFromFormFields(paramName, request, itemIndex);
+                    if (!paramValue)
+                        paramValue = paramFromQueries(paramName, request);
+                    return paramValue;
+                }));
+    return result;
 }
 } //namespace
 
@@ -149,22 +493,107 @@ void TaskProcessor<launchMode>::operator()(
         const asyncgi::Request& request,
         asyncgi::Response& response) const
 {
+    auto activeRequest = requestCounter_.get().startRequest();
+    if (!activeRequest) {
+        response.send(asyncgi::http::ResponseStatus::_503_Service_Unavailable, "Server is stopping");
+        return;
+    }
+    const auto trace = tracer_ ? tracer_->startRequestTrace() : RequestTrace{};
     try {
-        const auto taskProcess = makeProcessCfg(task_.get().process, task_.get().routeParams, routeParams, request);
-        if constexpr (launchMode == TaskLaunchMode::WaitingForResult)
-            processTaskLaunch(taskProcess, response);
-        else
-            processTaskLaunchDetached(taskProcess, response);
+        if constexpr (launchMode == TaskLaunchMode::Batch) {
+            const auto itemsNumber = batchSize(task_->process, request);
+            if (itemsNumber > task_->batchMaxItems) {
+                const auto errorMessage = fmt::format(
+                        "Batch request contains {} parameter sets, the limit is {}",
+                        itemsNumber,
+                        task_->batchMaxItems);
+                spdlog::error(errorMessage);
+                response.send(asyncgi::http::ResponseStatus::_400_Bad_Request, errorMessage);
+                return;
+            }
+            if (const auto errorMessage = batchParamsError(task_->process, itemsNumber, request)) {
+                spdlog::error(errorMessage.value());
+                response.send(asyncgi::http::ResponseStatus::_400_Bad_Request, errorMessage.value());
+                return;
+            }
+            const auto makeProcessCfgBeginTime = trace.now();
+            auto items = makeBatchProcessCfgs(task_->process, itemsNumber, task_->routeParams, routeParams, request);
+            trace.record("makeProcessCfg", makeProcessCfgBeginTime);
+            BatchLaunch::launch(
+                    std::move(items),
+                    *task_,
+                    priorityClass(),
+                    response,
+                    scheduler_.get(),
+                    shellPool_,
+                    trace,
+                    std::move(activeRequest));
+            return;
+        }
+
+        const auto makeProcessCfgBeginTime = trace.now();
+        auto taskProcess = makeProcessCfg(task_->process, task_->routeParams, routeParams, request);
+        trace.record("makeProcessCfg", makeProcessCfgBeginTime);
+
+        auto& scheduler = scheduler_.get();
+        const auto scheduleBeginTime = trace.now();
+        scheduler.schedule(
+                priorityClass(),
+                [taskProcess = std::move(taskProcess),
+                 &task = *task_,
+                 response,
+                 &scheduler,
+                 shellPool = shellPool_,
+                 jobRegistry = jobRegistry_,
+                 artifactStore = artifactStore_,
+                 trace,
+                 scheduleBeginTime,
+                 activeRequest = std::move(activeRequest)]() mutable
+                {
+                    trace.record("schedule", scheduleBeginTime);
+                    if constexpr (launchMode == TaskLaunchMode::WaitingForResult)
+                        processTaskLaunch(
+                                std::move(taskProcess),
+                                task,
+                                response,
+                                scheduler,
+                                shellPool,
+                                artifactStore,
+                                trace,
+                                std::move(activeRequest));
+                    else
+                        processTaskLaunchDetached(
+                                std::move(taskProcess),
+                                task,
+                                response,
+                                scheduler,
+                                shellPool,
+                                jobRegistry,
+                                trace,
+                                std::move(activeRequest));
+                });
     }
     catch (const ProcessCfgParametrizationError& error) {
-        const auto errorMessage = error.message(task_.get().process.command);
+        const auto errorMessage = error.message(task_->process.command);
         spdlog::error(errorMessage);
         response.send(asyncgi::http::ResponseStatus::_422_Unprocessable_Entity, errorMessage);
     }
 }
 
+template<TaskLaunchMode launchMode>
+const std::string& TaskProcessor<launchMode>::priorityClass() const
+{
+    if (!task_->priority.empty())
+        return task_->priority;
+    if constexpr (launchMode == TaskLaunchMode::WaitingForResult)
+        return interactivePriorityClass;
+    else
+        return batchPriorityClass;
+}
+
 template struct TaskProcessor<TaskLaunchMode::Detached>;
 template struct TaskProcessor<TaskLaunchMode::WaitingForResult>;
+template struct TaskProcessor<TaskLaunchMode::Batch>;
 
 
 } //namespace stone_skipper
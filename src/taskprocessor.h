@@ -1,24 +1,48 @@
 #pragma once
+#include "requestcounter.h"
 #include "task.h"
+#include "taskscheduler.h"
+#include "tracer.h"
 #include <asyncgi/asyncgi.h>
 #include <sfun/member.h>
+#include <memory>
 #include <utility>
 
 namespace stone_skipper {
 struct Task;
+class ShellPool;
+class JobRegistry;
+class ArtifactStore;
 
 enum class TaskLaunchMode {
     WaitingForResult,
-    Detached
+    Detached,
+    Batch
 };
 
 template<TaskLaunchMode launchMode>
 struct TaskProcessor {
-    explicit TaskProcessor(Task);
+    TaskProcessor(
+            std::shared_ptr<const Task>,
+            TaskScheduler&,
+            RequestCounter&,
+            Tracer*,
+            ShellPool*,
+            JobRegistry*,
+            ArtifactStore*);
     void operator()(const asyncgi::RouteParameters<>&, const asyncgi::Request&, asyncgi::Response&) const;
 
 private:
-    sfun::member<const Task> task_;
+    const std::string& priorityClass() const;
+
+private:
+    std::shared_ptr<const Task> task_;
+    sfun::member<TaskScheduler&> scheduler_;
+    sfun::member<RequestCounter&> requestCounter_;
+    Tracer* tracer_;
+    ShellPool* shellPool_;
+    JobRegistry* jobRegistry_;
+    ArtifactStore* artifactStore_;
 };
 
 } //namespace stone_skipper
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "taskscheduler.h"
+#include <sfun/contract.h>
+#include <algorithm>
+#include <utility>
+
+namespace stone_skipper {
+
+TaskScheduler::TaskScheduler(int maxRunningTasksNumber, const std::map<std::string, int>& priorityClassWeights)
+    : maxRunningTasksNumber_{maxRunningTasksNumber}
+{
+    for (const auto& [name, weight] : priorityClassWeights) {
+        sfun_contract_check(weight > 0);
+        priorityClasses_.emplace(name, PriorityClass{.weight = weight});
+    }
+    priorityClasses_.try_emplace(interactivePriorityClass, PriorityClass{.weight = 8});
+    priorityClasses_.try_emplace(batchPriorityClass, PriorityClass{.weight = 1});
+}
+
+bool TaskScheduler::hasPriorityClass(const std::string& priorityClass) const
+{
+    return priorityClasses_.contains(priorityClass);
+}
+
+bool TaskScheduler::hasActiveTasks() const
+{
+    auto lock = std::scoped_lock{mutex_};
+    return runningTasksNumber_ > 0;
+}
+
+void TaskScheduler::schedule(const std::string& priorityClassName, std::function<void()> taskLaunch)
+{
+    auto priorityClassIt = priorityClasses_.find(priorityClassName);
+    sfun_contract_check(priorityClassIt != priorityClasses_.end());
+    auto& priorityClass = priorityClassIt->second;
+    {
+        auto lock = std::scoped_lock{mutex_};
+        if (priorityClass.queue.empty())
+            priorityClass.pass = std::max(priorityClass.pass, pass_);
+        if (maxRunningTasksNumber_ > 0 && runningTasksNumber_ >= maxRunningTasksNumber_) {
+            priorityClass.queue.push_back(std::move(taskLaunch));
+            return;
+        }
+        ++runningTasksNumber_;
+        charge(priorityClass);
+    }
+    taskLaunch();
+}
+
+void TaskScheduler::onTaskFinished()
+{
+    auto nextTaskLaunch = std::function<void()>{};
+    {
+        auto lock = std::scoped_lock{mutex_};
+        auto nextClassIt = priorityClasses_.end();
+        for (auto it = priorityClasses_.begin(); it != priorityClasses_.end(); ++it) {
+            if (it->second.queue.empty())
+                continue;
+            if (nextClassIt == priorityClasses_.end() || it->second.pass < nextClassIt->second.pass)
+                nextClassIt = it;
+        }
+        if (nextClassIt == priorityClasses_.end()) {
+            --runningTasksNumber_;
+            return;
+        }
+        auto& nextClass = nextClassIt->second;
+        nextTaskLaunch = std::move(nextClass.queue.front());
+        nextClass.queue.pop_front();
+        charge(nextClass);
+    }
+    nextTaskLaunch();
+}
+
+void TaskScheduler::charge(PriorityClass& priorityClass)
+{
+    pass_ = std::max(pass_, priorityClass.pass);
+    priorityClass.pass += 1.0 / priorityClass.weight;
+}
+
+} //namespace stone_skipper
@@ -0,0 +1,37 @@
+#pragma once
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace stone_skipper {
+
+inline const auto interactivePriorityClass = std::string{"interactive"};
+inline const auto batchPriorityClass = std::string{"batch"};
+
+class TaskScheduler {
+public:
+    TaskScheduler(int maxRunningTasksNumber, const std::map<std::string, int>& priorityClassWeights);
+    void schedule(const std::string& priorityClass, std::function<void()> taskLaunch);
+    void onTaskFinished();
+    bool hasPriorityClass(const std::string& priorityClass) const;
+    bool hasActiveTasks() const;
+
+private:
+    struct PriorityClass {
+        int weight;
+        double pass = 0;
+        std::deque<std::function<void()>> queue = {};
+    };
+    void charge(PriorityClass&);
+
+private:
+    int maxRunningTasksNumber_;
+    int runningTasksNumber_ = 0;
+    double pass_ = 0;
+    std::map<std::string, PriorityClass> priorityClasses_;
+    mutable std::mutex mutex_;
+};
+
+} //namespace stone_skipper
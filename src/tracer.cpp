@@ -0,0 +1,227 @@
+#include "tracer.h"
+#include "errors.h"
+#include <fmt/format.h>
+#include <sfun/path.h>
+#include <spdlog/spdlog.h>
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+#include <array>
+#include <chrono>
+#include <random>
+
+namespace stone_skipper {
+
+namespace {
+
+int processId()
+{
+#ifdef _WIN32
+    return _getpid();
+#else
+    return static_cast<int>(getpid());
+#endif
+}
+
+auto nextTracerId = std::atomic<std::uint64_t>{1};
+
+} //namespace
+
+class Tracer::EventRing {
+public:
+    explicit EventRing(int threadId)
+        : threadId_{threadId}
+    {
+    }
+
+    int threadId() const
+    {
+        return threadId_;
+    }
+
+    bool push(const TraceEvent& event)
+    {
+        const auto head = head_.load(std::memory_order_relaxed);
+        const auto tail = tail_.load(std::memory_order_acquire);
+        if (head - tail == events_.size())
+            return false;
+        events_[head % events_.size()] = event;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    template<typename TFunc>
+    void consume(TFunc&& eventHandler)
+    {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        const auto head = head_.load(std::memory_order_acquire);
+        for (auto i = tail; i != head; ++i)
+            eventHandler(events_[i % events_.size()]);
+        tail_.store(head, std::memory_order_release);
+    }
+
+private:
+    int threadId_;
+    std::array<TraceEvent, 4096> events_;
+    std::atomic<std::size_t> head_ = 0;
+    std::atomic<std::size_t> tail_ = 0;
+};
+
+Tracer::Tracer(std::filesystem::path traceFilePath, double samplingRate, std::uintmax_t maxTraceFileSize)
+    : id_{nextTracerId++}
+    , traceFilePath_{std::move(traceFilePath)}
+    , samplingRate_{samplingRate}
+    , maxTraceFileSize_{maxTraceFileSize}
+{
+    openTraceFile();
+    flushThread_ = std::jthread{[this](std::stop_token stopToken)
+                                {
+                                    flushEvents(std::move(stopToken));
+                                }};
+}
+
+Tracer::~Tracer()
+{
+    flushThread_.request_stop();
+    flushThread_.join();
+    writeEvents();
+    if (droppedEventsNumber_ > 0)
+        spdlog::warn("{} trace events were dropped because of the full trace buffers", droppedEventsNumber_.load());
+}
+
+std::int64_t Tracer::now()
+{
+    const auto time = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+}
+
+RequestTrace Tracer::startRequestTrace()
+{
+    if (samplingRate_ < 1.0) {
+        thread_local auto randomEngine = std::minstd_rand{std::random_device{}()};
+        auto distribution = std::uniform_real_distribution<double>{0.0, 1.0};
+        if (distribution(randomEngine) >= samplingRate_)
+            return {};
+    }
+    return RequestTrace{*this, nextRequestId_++};
+}
+
+void Tracer::record(const TraceEvent& event)
+{
+    if (!threadEventRing().push(event))
+        ++droppedEventsNumber_;
+}
+
+Tracer::EventRing& Tracer::threadEventRing()
+{
+    // keyed by the tracer id, as a new tracer can be created at the address of a destroyed one
+    thread_local auto threadEventRing = std::pair<std::uint64_t, EventRing*>{};
+    if (threadEventRing.first != id_) {
+        auto lock = std::scoped_lock{eventRingsMutex_};
+        const auto threadId = static_cast<int>(eventRings_.size());
+        threadEventRing = {id_, eventRings_.emplace_back(std::make_unique<EventRing>(threadId)).get()};
+    }
+    return *threadEventRing.second;
+}
+
+void Tracer::flushEvents(std::stop_token stopToken)
+{
+    using namespace std::chrono_literals;
+    auto mutex = std::mutex{};
+    while (!stopToken.stop_requested()) {
+        auto lock = std::unique_lock{mutex};
+        flushCondition_.wait_for(
+                lock,
+                stopToken,
+                1s,
+                []
+                {
+                    return false;
+                });
+        writeEvents();
+    }
+}
+
+void Tracer::writeEvents()
+{
+    auto lock = std::scoped_lock{eventRingsMutex_};
+    const auto pid = processId();
+    for (auto& eventRing : eventRings_)
+        eventRing->consume(
+                [&](const TraceEvent& event)
+                {
+                    traceFile_ << fmt::format(
+                            R"({{"name":"{}","cat":"stone_skipper","ph":"X","ts":{},"dur":{},"pid":{},"tid":{},)"
+                            R"("args":{{"request":{}{}}}}},)"
+                            "\n",
+                            event.name,
+                            event.beginTime,
+                            event.endTime - event.beginTime,
+                            pid,
+                            eventRing->threadId(),
+                            event.requestId,
+                            event.batchItemIndex >= 0 ? fmt::format(R"(,"batchItem":{})", event.batchItemIndex)
+                                                      : std::string{});
+                });
+    traceFile_.flush();
+
+    if (static_cast<std::uintmax_t>(traceFile_.tellp()) >= maxTraceFileSize_) {
+        traceFile_.close();
+        auto previousTraceFilePath = traceFilePath_;
+        previousTraceFilePath += ".1";
+        auto error = std::error_code{};
+        std::filesystem::rename(traceFilePath_, previousTraceFilePath, error);
+        if (error)
+            spdlog::error("Couldn't rotate the trace file {}: {}", sfun::path_string(traceFilePath_), error.message());
+        openTraceFile();
+    }
+}
+
+void Tracer::openTraceFile()
+{
+    traceFile_.open(traceFilePath_, std::ios::trunc);
+    if (!traceFile_.is_open())
+        throw Error{fmt::format("Couldn't open the trace file {}", sfun::path_string(traceFilePath_))};
+    traceFile_ << "[\n";
+}
+
+RequestTrace::RequestTrace(Tracer& tracer, std::uint64_t requestId)
+    : tracer_{&tracer}
+    , requestId_{requestId}
+{
+}
+
+RequestTrace::operator bool() const
+{
+    return tracer_ != nullptr;
+}
+
+std::int64_t RequestTrace::now() const
+{
+    if (!tracer_)
+        return 0;
+    return Tracer::now();
+}
+
+void RequestTrace::record(const char* name, std::int64_t beginTime) const
+{
+    if (!tracer_)
+        return;
+    tracer_->record(
+            {.name = name,
+             .requestId = requestId_,
+             .beginTime = beginTime,
+             .endTime = Tracer::now(),
+             .batchItemIndex = batchItemIndex_});
+}
+
+RequestTrace RequestTrace::batchItemTrace(int batchItemIndex) const
+{
+    auto result = *this;
+    result.batchItemIndex_ = batchItemIndex;
+    return result;
+}
+
+} //namespace stone_skipper
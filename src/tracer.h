@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace stone_skipper {
+
+struct TraceEvent {
+    const char* name;
+    std::uint64_t requestId;
+    std::int64_t beginTime;
+    std::int64_t endTime;
+    int batchItemIndex;
+};
+
+class RequestTrace;
+
+class Tracer {
+public:
+    Tracer(std::filesystem::path traceFilePath, double samplingRate, std::uintmax_t maxTraceFileSize);
+    ~Tracer();
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    RequestTrace startRequestTrace();
+    void record(const TraceEvent&);
+    static std::int64_t now();
+
+private:
+    class EventRing;
+    EventRing& threadEventRing();
+    void flushEvents(std::stop_token);
+    void writeEvents();
+    void openTraceFile();
+
+private:
+    std::uint64_t id_;
+    std::filesystem::path traceFilePath_;
+    double samplingRate_;
+    std::uintmax_t maxTraceFileSize_;
+    std::atomic<std::uint64_t> nextRequestId_ = 1;
+    std::atomic<std::uint64_t> droppedEventsNumber_ = 0;
+    std::vector<std::unique_ptr<EventRing>> eventRings_;
+    std::mutex eventRingsMutex_;
+    std::ofstream traceFile_;
+    std::condition_variable_any flushCondition_;
+    std::jthread flushThread_;
+};
+
+class RequestTrace {
+public:
+    RequestTrace() = default;
+    RequestTrace(Tracer&, std::uint64_t requestId);
+
+    explicit operator bool() const;
+    std::int64_t now() const;
+    void record(const char* name, std::int64_t beginTime) const;
+    RequestTrace batchItemTrace(int batchItemIndex) const;
+
+private:
+    Tracer* tracer_ = nullptr;
+    std::uint64_t requestId_ = 0;
+    int batchItemIndex_ = -1;
+};
+
+} //namespace stone_skipper
@@ -0,0 +1,210 @@
+#include "upgrade.h"
+#include "errors.h"
+#include <fmt/format.h>
+#include <sfun/path.h>
+#include <spdlog/spdlog.h>
+#ifndef _WIN32
+#include <pthread.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace stone_skipper {
+
+namespace {
+
+#ifndef _WIN32
+struct FileId {
+    dev_t device;
+    ino_t inode;
+
+    friend bool operator==(const FileId&, const FileId&) = default;
+};
+
+std::optional<FileId> fileId(const fs::path& path)
+{
+    struct stat fileStat = {};
+    if (stat(path.c_str(), &fileStat) != 0)
+        return std::nullopt;
+    return FileId{fileStat.st_dev, fileStat.st_ino};
+}
+
+sigset_t drainSignalSet()
+{
+    auto signals = sigset_t{};
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR2);
+    return signals;
+}
+#endif
+
+const auto responseFlushTime = std::chrono::seconds{1};
+
+void sleepUntil(std::chrono::steady_clock::time_point time)
+{
+    if (time > std::chrono::steady_clock::now())
+        std::this_thread::sleep_until(time);
+}
+
+template<typename TPredicate>
+bool waitUntil(
+        const TPredicate& predicate,
+        std::chrono::steady_clock::time_point deadline,
+        const std::stop_token& stopToken)
+{
+    using namespace std::chrono_literals;
+    while (!predicate()) {
+        if (stopToken.stop_requested() || std::chrono::steady_clock::now() >= deadline)
+            return false;
+        std::this_thread::sleep_for(100ms);
+    }
+    return true;
+}
+
+} //namespace
+
+std::optional<int> readInstancePid(const fs::path& pidFilePath)
+{
+    auto stream = std::ifstream{pidFilePath};
+    auto pid = 0;
+    if (!(stream >> pid) || pid <= 0)
+        return std::nullopt;
+    return pid;
+}
+
+void writeInstancePid(const fs::path& pidFilePath)
+{
+#ifndef _WIN32
+    auto stream = std::ofstream{pidFilePath};
+    if (!(stream << getpid()))
+        throw Error{fmt::format("Couldn't write the pid file {}", sfun::path_string(pidFilePath))};
+#else
+    throw Error{"Pid files aren't supported on Windows"};
+#endif
+}
+
+void requestInstanceDrain([[maybe_unused]] int pid)
+{
+#ifndef _WIN32
+    if (kill(pid, SIGUSR2) != 0)
+        throw Error{fmt::format("Couldn't signal the running instance with pid {}: {}", pid, std::strerror(errno))};
+    spdlog::info("The running instance with pid {} was requested to drain and stop", pid);
+#else
+    throw Error{"Binary upgrade isn't supported on Windows"};
+#endif
+}
+
+void blockDrainSignal()
+{
+#ifndef _WIN32
+    const auto signals = drainSignalSet();
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+#endif
+}
+
+void listenOnReplacedSocket(const fs::path& socketPath, const std::function<void(const fs::path&)>& listen)
+{
+    auto temporarySocketPath = socketPath;
+    temporarySocketPath += ".upgrade";
+    auto error = std::error_code{};
+    fs::remove(temporarySocketPath, error);
+    listen(temporarySocketPath);
+    fs::rename(temporarySocketPath, socketPath);
+}
+
+DrainHandler::DrainHandler(
+        std::optional<fs::path> socketPath,
+        std::chrono::seconds drainTimeout,
+        std::function<bool()> hasActiveRequests,
+        std::function<void()> stopAcceptingRequests,
+        std::function<void()> stopServer)
+    : socketPath_{std::move(socketPath)}
+    , drainTimeout_{drainTimeout}
+    , hasActiveRequests_{std::move(hasActiveRequests)}
+    , stopAcceptingRequests_{std::move(stopAcceptingRequests)}
+    , stopServer_{std::move(stopServer)}
+{
+#ifndef _WIN32
+    if (socketPath_.has_value())
+        isSocketReplaced_ = [socketPath = socketPath_.value(), socketId = fileId(socketPath_.value())]
+        {
+            const auto currentSocketId = fileId(socketPath);
+            return currentSocketId.has_value() && currentSocketId != socketId;
+        };
+    thread_ = std::jthread{[this](std::stop_token stopToken)
+                           {
+                               waitForDrainSignal(std::move(stopToken));
+                           }};
+#endif
+}
+
+DrainHandler::~DrainHandler()
+{
+#ifndef _WIN32
+    thread_.request_stop();
+    pthread_kill(thread_.native_handle(), SIGUSR2);
+    thread_.join();
+#endif
+}
+
+void DrainHandler::waitForDrainSignal([[maybe_unused]] std::stop_token stopToken)
+{
+#ifndef _WIN32
+    const auto signals = drainSignalSet();
+    auto signal = 0;
+    while (!stopToken.stop_requested()) {
+        if (sigwait(&signals, &signal) != 0 || stopToken.stop_requested())
+            continue;
+        if (drain(stopToken))
+            return;
+    }
+#endif
+}
+
+bool DrainHandler::drain([[maybe_unused]] std::stop_token stopToken)
+{
+#ifndef _WIN32
+    using namespace std::chrono_literals;
+    spdlog::info("stone_skipper task server is draining");
+    const auto deadline = std::chrono::steady_clock::now() + drainTimeout_;
+    const auto requestsDeadline =
+            deadline - std::min<std::chrono::steady_clock::duration>(responseFlushTime, drainTimeout_);
+
+    if (socketPath_.has_value()) {
+        const auto isSocketReplaced = waitUntil(isSocketReplaced_, requestsDeadline, stopToken);
+        if (!isSocketReplaced) {
+            spdlog::warn(
+                    "The socket {} wasn't replaced by a new instance, the drain is cancelled",
+                    sfun::path_string(socketPath_.value()));
+            return false;
+        }
+        sleepUntil(std::min(std::chrono::steady_clock::now() + 1s, requestsDeadline));
+    }
+
+    const auto isDrained = waitUntil(
+            [&]
+            {
+                return !hasActiveRequests_();
+            },
+            requestsDeadline,
+            stopToken);
+    if (!isDrained)
+        spdlog::warn("stone_skipper task server is stopping with unfinished requests after the drain timeout");
+    stopAcceptingRequests_();
+    // asyncgi doesn't report when the responses are written, so the ones that were sent last get time to be flushed
+    sleepUntil(std::min(std::chrono::steady_clock::now() + responseFlushTime, deadline));
+    stopServer_();
+    return true;
+#else
+    return true;
+#endif
+}
+
+} //namespace stone_skipper
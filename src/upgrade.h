@@ -0,0 +1,44 @@
+#pragma once
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <thread>
+
+namespace stone_skipper {
+
+std::optional<int> readInstancePid(const std::filesystem::path& pidFilePath);
+void writeInstancePid(const std::filesystem::path& pidFilePath);
+void requestInstanceDrain(int pid);
+void blockDrainSignal();
+void listenOnReplacedSocket(
+        const std::filesystem::path& socketPath,
+        const std::function<void(const std::filesystem::path&)>& listen);
+
+class DrainHandler {
+public:
+    DrainHandler(
+            std::optional<std::filesystem::path> socketPath,
+            std::chrono::seconds drainTimeout,
+            std::function<bool()> hasActiveRequests,
+            std::function<void()> stopAcceptingRequests,
+            std::function<void()> stopServer);
+    ~DrainHandler();
+    DrainHandler(const DrainHandler&) = delete;
+    DrainHandler& operator=(const DrainHandler&) = delete;
+
+private:
+    void waitForDrainSignal(std::stop_token);
+    bool drain(std::stop_token);
+
+private:
+    std::optional<std::filesystem::path> socketPath_;
+    std::chrono::seconds drainTimeout_;
+    std::function<bool()> hasActiveRequests_;
+    std::function<void()> stopAcceptingRequests_;
+    std::function<void()> stopServer_;
+    std::function<bool()> isSocketReplaced_;
+    std::jthread thread_;
+};
+
+} //namespace stone_skipper
@@ -3,6 +3,9 @@
 #include <fmt/format.h>
 #include <sfun/string_utils.h>
 #include <gsl/util>
+#include <algorithm>
+#include <charconv>
+#include <string_view>
 
 namespace stone_skipper {
 
@@ -76,6 +79,15 @@ private:
     std::stringstream stream_;
 };
 
+std::optional<int> readCpuIndex(std::string_view str)
+{
+    auto index = 0;
+    const auto [end, error] = std::from_chars(str.data(), str.data() + str.size(), index);
+    if (error != std::errc{} || end != str.data() + str.size() || index < 0)
+        return std::nullopt;
+    return index;
+}
+
 } //namespace
 
 std::vector<std::string> splitCommand(const std::string& str)
@@ -112,4 +124,32 @@ std::vector<std::string> splitCommand(const std::string& str)
     return result;
 }
 
+std::vector<int> parseCpuList(const std::string& str, int maxCpuIndex)
+{
+    auto result = std::vector<int>{};
+    auto listView = std::string_view{str};
+    while (!listView.empty()) {
+        const auto itemEnd = listView.find(',');
+        const auto item = listView.substr(0, itemEnd);
+        listView = itemEnd == std::string_view::npos ? std::string_view{} : listView.substr(itemEnd + 1);
+
+        const auto rangeSeparatorPos = item.find('-');
+        const auto firstCpu = readCpuIndex(item.substr(0, rangeSeparatorPos));
+        const auto lastCpu =
+                rangeSeparatorPos == std::string_view::npos ? firstCpu : readCpuIndex(item.substr(rangeSeparatorPos + 1));
+        if (!firstCpu.has_value() || !lastCpu.has_value() || firstCpu.value() > lastCpu.value())
+            throw Error{fmt::format("CPU list '{}' has an invalid item '{}'", str, item)};
+        if (lastCpu.value() > maxCpuIndex)
+            throw Error{fmt::format("CPU list '{}' contains a CPU index above {}", str, maxCpuIndex)};
+        for (auto cpu = firstCpu.value(); cpu <= lastCpu.value(); ++cpu)
+            result.push_back(cpu);
+    }
+    if (result.empty())
+        throw Error{fmt::format("CPU list '{}' is empty", str)};
+    std::ranges::sort(result);
+    const auto duplicates = std::ranges::unique(result);
+    result.erase(duplicates.begin(), duplicates.end());
+    return result;
+}
+
 } //namespace stone_skipper
\ No newline at end of file
@@ -2,9 +2,11 @@
 #include <optional>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace stone_skipper {
 
 std::vector<std::string> splitCommand(const std::string& str);
+std::vector<int> parseCpuList(const std::string& str, int maxCpuIndex);
 
 } //namespace stone_skipper
\ No newline at end of file
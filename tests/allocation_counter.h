@@ -0,0 +1,22 @@
+#pragma once
+#include <atomic>
+
+inline std::atomic<bool> isAllocationCountingEnabled = false;
+inline std::atomic<int> allocationsNumber = 0;
+
+class AllocationCounter {
+public:
+    AllocationCounter()
+    {
+        allocationsNumber = 0;
+        isAllocationCountingEnabled = true;
+    }
+    ~AllocationCounter()
+    {
+        isAllocationCountingEnabled = false;
+    }
+    int count() const
+    {
+        return allocationsNumber;
+    }
+};
@@ -0,0 +1,164 @@
+#include <artifactstore.h>
+#include <gtest/gtest.h>
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+int processId()
+{
+#ifndef _WIN32
+    return static_cast<int>(getpid());
+#else
+    return _getpid();
+#endif
+}
+
+std::string partFileName(const std::string& name, int ownerPid = processId())
+{
+    return name + "." + std::to_string(ownerPid) + ".part";
+}
+
+class ArtifactStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        fs::remove_all(dir);
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(dir);
+    }
+
+    void writeArtifact(const std::string& name, std::size_t size, std::chrono::minutes age)
+    {
+        auto stream = std::ofstream{dir / name};
+        stream << std::string(size, 'x');
+        stream.close();
+        fs::last_write_time(dir / name, fs::file_time_type::clock::now() - age);
+    }
+
+    const fs::path dir = fs::temp_directory_path() / "stone_skipper_test_artifacts";
+};
+
+} //namespace
+
+TEST_F(ArtifactStoreTest, Commit)
+{
+    const auto store = stone_skipper::ArtifactStore{
+            dir,
+            {.maxAge = std::chrono::seconds{0}, .maxCount = 0, .maxSize = 0},
+            stone_skipper::ArtifactHeader::AccelRedirect,
+            "/artifacts"};
+    const auto artifact = store.makeArtifact(".txt");
+    ASSERT_EQ(artifact.path.parent_path(), fs::absolute(dir));
+    ASSERT_EQ(artifact.path.filename(), artifact.name);
+    ASSERT_EQ(artifact.path.extension(), ".txt");
+    ASSERT_EQ(artifact.partPath.filename(), partFileName(artifact.name));
+    {
+        auto stream = std::ofstream{artifact.partPath};
+        stream << "Hello world";
+    }
+    store.commit(artifact);
+    ASSERT_TRUE(fs::exists(artifact.path));
+    ASSERT_FALSE(fs::exists(artifact.partPath));
+    ASSERT_EQ(store.headerName(), "X-Accel-Redirect");
+    ASSERT_EQ(store.headerValue(artifact), "/artifacts/" + artifact.name);
+}
+
+TEST_F(ArtifactStoreTest, Discard)
+{
+    const auto store = stone_skipper::ArtifactStore{
+            dir,
+            {.maxAge = std::chrono::seconds{0}, .maxCount = 0, .maxSize = 0},
+            stone_skipper::ArtifactHeader::Sendfile,
+            {}};
+    const auto artifact = store.makeArtifact({});
+    {
+        auto stream = std::ofstream{artifact.partPath};
+        stream << "Hello world";
+    }
+    store.discard(artifact);
+    ASSERT_FALSE(fs::exists(artifact.partPath));
+    ASSERT_EQ(store.headerName(), "X-Sendfile");
+    ASSERT_EQ(store.headerValue(artifact), artifact.path.string());
+}
+
+TEST_F(ArtifactStoreTest, RemoveExpiredArtifacts)
+{
+    fs::create_directories(dir);
+    writeArtifact("expired", 1, std::chrono::minutes{120});
+    writeArtifact(partFileName("long_running"), 1, std::chrono::minutes{120});
+    writeArtifact(partFileName("running"), 100, std::chrono::minutes{5});
+    writeArtifact("oldest", 1, std::chrono::minutes{50});
+    writeArtifact("large", 10, std::chrono::minutes{40});
+    writeArtifact("old", 1, std::chrono::minutes{30});
+    writeArtifact("new", 1, std::chrono::minutes{20});
+    writeArtifact("recent", 10, std::chrono::minutes{0});
+    writeArtifact("older", 1, std::chrono::minutes{55});
+
+    auto store = stone_skipper::ArtifactStore{
+            dir,
+            {.maxAge = std::chrono::hours{1}, .maxCount = 4, .maxSize = 14},
+            stone_skipper::ArtifactHeader::AccelRedirect,
+            "/artifacts/"};
+    ASSERT_FALSE(fs::exists(dir / "expired"));
+    ASSERT_TRUE(fs::exists(dir / partFileName("long_running")));
+    ASSERT_TRUE(fs::exists(dir / partFileName("running")));
+    ASSERT_TRUE(fs::exists(dir / "oldest"));
+    ASSERT_FALSE(fs::exists(dir / "large"));
+    ASSERT_TRUE(fs::exists(dir / "old"));
+    ASSERT_TRUE(fs::exists(dir / "new"));
+    ASSERT_TRUE(fs::exists(dir / "recent"));
+    ASSERT_FALSE(fs::exists(dir / "older"));
+}
+
+TEST_F(ArtifactStoreTest, RecentArtifactsAreKept)
+{
+    fs::create_directories(dir);
+    writeArtifact("first", 1, std::chrono::minutes{0});
+    writeArtifact("second", 1, std::chrono::minutes{0});
+
+    auto store = stone_skipper::ArtifactStore{
+            dir,
+            {.maxAge = std::chrono::hours{1}, .maxCount = 1, .maxSize = 0},
+            stone_skipper::ArtifactHeader::AccelRedirect,
+            "/artifacts/"};
+    ASSERT_TRUE(fs::exists(dir / "first"));
+    ASSERT_TRUE(fs::exists(dir / "second"));
+}
+
+#ifndef _WIN32
+TEST_F(ArtifactStoreTest, RemoveAbandonedPartFiles)
+{
+    const auto exitedPid = fork();
+    if (exitedPid == 0)
+        _exit(0);
+    waitpid(exitedPid, nullptr, 0);
+
+    fs::create_directories(dir);
+    writeArtifact(partFileName("abandoned", exitedPid), 1, std::chrono::minutes{0});
+    writeArtifact(partFileName("running"), 1, std::chrono::minutes{0});
+    writeArtifact("unknown.part", 1, std::chrono::minutes{0});
+
+    auto store = stone_skipper::ArtifactStore{
+            dir,
+            {.maxAge = std::chrono::seconds{0}, .maxCount = 0, .maxSize = 0},
+            stone_skipper::ArtifactHeader::AccelRedirect,
+            "/artifacts/"};
+    ASSERT_FALSE(fs::exists(dir / partFileName("abandoned", exitedPid)));
+    ASSERT_TRUE(fs::exists(dir / partFileName("running")));
+    ASSERT_FALSE(fs::exists(dir / "unknown.part"));
+}
+#endif
@@ -0,0 +1,72 @@
+#include <childreaper.h>
+#include <gtest/gtest.h>
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <vector>
+
+namespace {
+
+int launchChild(int exitCode, std::size_t allocatedSize)
+{
+    const auto pid = fork();
+    if (pid == 0) {
+        auto data = std::vector<char>(allocatedSize);
+        std::memset(data.data(), 1, data.size());
+        _exit(exitCode + data.back() - 1);
+    }
+    return pid;
+}
+
+} //namespace
+
+TEST(ChildReaper, CollectsExitStatusAndResourceUsage)
+{
+    using namespace std::chrono_literals;
+    auto io = boost::asio::io_context{};
+    auto& childReaper = boost::asio::use_service<stone_skipper::ChildReaper>(io);
+    auto exitCodes = std::map<int, int>{};
+    auto maxResidentSetSizes = std::map<int, long>{};
+    for (const auto exitCode : {3, 5}) {
+        const auto pid = launchChild(exitCode, 16 * 1024 * 1024);
+        ASSERT_GT(pid, 0);
+        childReaper.watch(
+                pid,
+                [&, exitCode](int status, const stone_skipper::ResourceUsage& resourceUsage)
+                {
+                    exitCodes[exitCode] = WEXITSTATUS(status);
+                    maxResidentSetSizes[exitCode] = resourceUsage.maxResidentSetSize;
+                });
+    }
+    while (exitCodes.size() < 2 && io.run_one_for(5s) > 0) {
+    }
+
+    ASSERT_EQ(exitCodes, (std::map<int, int>{{3, 3}, {5, 5}}));
+    for (const auto& [exitCode, maxResidentSetSize] : maxResidentSetSizes)
+        EXPECT_GE(maxResidentSetSize, 16 * 1024);
+}
+
+TEST(ChildReaper, ChildExitedBeforeWatch)
+{
+    using namespace std::chrono_literals;
+    auto io = boost::asio::io_context{};
+    auto& childReaper = boost::asio::use_service<stone_skipper::ChildReaper>(io);
+    const auto pid = launchChild(7, 4096);
+    ASSERT_GT(pid, 0);
+    auto childInfo = siginfo_t{};
+    ASSERT_EQ(waitid(P_PID, static_cast<id_t>(pid), &childInfo, WEXITED | WNOWAIT), 0);
+    io.run_for(100ms);
+
+    auto exitCode = -1;
+    childReaper.watch(
+            pid,
+            [&](int status, const stone_skipper::ResourceUsage&)
+            {
+                exitCode = WEXITSTATUS(status);
+            });
+    ASSERT_EQ(exitCode, 7);
+}
+#endif
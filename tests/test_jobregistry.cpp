@@ -0,0 +1,55 @@
+#include <jobregistry.h>
+#include <gtest/gtest.h>
+
+TEST(JobRegistry, SingleWorkerJobIds)
+{
+    auto registry = stone_skipper::JobRegistry{16, 10};
+    const auto [firstJobId, firstJob] = registry.addJob();
+    const auto [secondJobId, secondJob] = registry.addJob();
+    ASSERT_EQ(firstJobId, 1);
+    ASSERT_EQ(secondJobId, 2);
+    ASSERT_EQ(registry.job(1), firstJob);
+    ASSERT_EQ(registry.job(2), secondJob);
+    ASSERT_EQ(registry.job(3), nullptr);
+}
+
+TEST(JobRegistry, WorkerJobIds)
+{
+    auto firstWorkerRegistry = stone_skipper::JobRegistry{16, 10, 0, 3};
+    auto secondWorkerRegistry = stone_skipper::JobRegistry{16, 10, 1, 3};
+    const auto [firstWorkerJobId, firstWorkerJob] = firstWorkerRegistry.addJob();
+    const auto [secondWorkerJobId, secondWorkerJob] = secondWorkerRegistry.addJob();
+    ASSERT_NE(firstWorkerJobId, secondWorkerJobId);
+    ASSERT_TRUE(firstWorkerRegistry.isOwnJob(firstWorkerJobId));
+    ASSERT_FALSE(firstWorkerRegistry.isOwnJob(secondWorkerJobId));
+    ASSERT_TRUE(secondWorkerRegistry.isOwnJob(secondWorkerJobId));
+    ASSERT_FALSE(secondWorkerRegistry.isOwnJob(firstWorkerJobId));
+    ASSERT_EQ(firstWorkerRegistry.job(secondWorkerJobId), nullptr);
+    ASSERT_EQ(secondWorkerRegistry.job(secondWorkerJobId), secondWorkerJob);
+}
+
+TEST(JobRegistry, JobPaths)
+{
+    auto registry = stone_skipper::JobRegistry{16, 10};
+    const auto [jobId, job] = registry.addJob();
+    ASSERT_EQ(registry.jobPath(jobId), "/jobs/1");
+
+    auto workerRegistry = stone_skipper::JobRegistry{16, 10, 1, 3};
+    const auto [workerJobId, workerJob] = workerRegistry.addJob();
+    ASSERT_EQ(workerRegistry.jobPath(workerJobId), "/jobs/1/4");
+    ASSERT_EQ(stone_skipper::jobRoutePattern(1), "/jobs/(\\d+)");
+    ASSERT_EQ(stone_skipper::jobRoutePattern(3), "/jobs/(\\d+)/(\\d+)");
+}
+
+TEST(JobRegistry, RemovesOldestFinishedJobs)
+{
+    auto registry = stone_skipper::JobRegistry{16, 1};
+    const auto [firstJobId, firstJob] = registry.addJob();
+    const auto [secondJobId, secondJob] = registry.addJob();
+    firstJob->finish(0);
+    secondJob->finish(0);
+    const auto [thirdJobId, thirdJob] = registry.addJob();
+    ASSERT_EQ(registry.job(firstJobId), nullptr);
+    ASSERT_EQ(registry.job(secondJobId), secondJob);
+    ASSERT_EQ(registry.job(thirdJobId), thirdJob);
+}
@@ -0,0 +1,50 @@
+#include <outputring.h>
+#include <gtest/gtest.h>
+
+TEST(OutputRing, Read)
+{
+    auto ring = stone_skipper::OutputRing{8};
+    ring.write("Hello");
+    ring.write(" ");
+    const auto slice = ring.read(0);
+    ASSERT_EQ(slice.data, "Hello ");
+    ASSERT_EQ(slice.offset, 0);
+    ASSERT_EQ(slice.nextOffset, 6);
+    ASSERT_EQ(ring.read(4).data, "o ");
+    ASSERT_EQ(ring.read(6).data, "");
+}
+
+TEST(OutputRing, ReadAfterWrapAround)
+{
+    auto ring = stone_skipper::OutputRing{8};
+    ring.write("Hello ");
+    ring.write("world");
+    ASSERT_EQ(ring.beginOffset(), 3);
+    ASSERT_EQ(ring.endOffset(), 11);
+    const auto slice = ring.read(0);
+    ASSERT_EQ(slice.data, "lo world");
+    ASSERT_EQ(slice.offset, 3);
+    ASSERT_EQ(slice.nextOffset, 11);
+    ASSERT_EQ(ring.read(8).data, "rld");
+}
+
+TEST(OutputRing, WriteLargerThanCapacity)
+{
+    auto ring = stone_skipper::OutputRing{4};
+    ring.write("Hi");
+    ring.write("Hello world");
+    const auto slice = ring.read(0);
+    ASSERT_EQ(slice.data, "orld");
+    ASSERT_EQ(slice.offset, 9);
+    ASSERT_EQ(slice.nextOffset, 13);
+}
+
+TEST(OutputRing, ReadPastEnd)
+{
+    auto ring = stone_skipper::OutputRing{4};
+    ring.write("Hi");
+    const auto slice = ring.read(10);
+    ASSERT_EQ(slice.data, "");
+    ASSERT_EQ(slice.offset, 2);
+    ASSERT_EQ(slice.nextOffset, 2);
+}
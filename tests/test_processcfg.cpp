@@ -0,0 +1,137 @@
+#include "allocation_counter.h"
+#include "assert_exception.h"
+#include <processcfg.h>
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <new>
+#include <optional>
+#include <string_view>
+
+namespace {
+std::optional<std::string_view> testParamValue(std::string_view param)
+{
+    if (param == "name")
+        return "world";
+    if (param == "greeting")
+        return "Hello";
+    return std::nullopt;
+}
+
+stone_skipper::ProcessCfg makeTemplateProcessCfg()
+{
+    auto processCfg = stone_skipper::ProcessCfg{};
+    processCfg.command = "echo \"{{greeting}} {{name}}\" && echo {{unknown_param_is_kept}}";
+    processCfg.params = {"greeting", "name"};
+    processCfg.shellCommand = std::make_shared<const std::vector<std::string>>(
+            std::vector<std::string>{"bash", "-ceo", "pipefail"});
+    processCfg.workingDir = "/tmp";
+    processCfg.environment = stone_skipper::ProcessEnvironment{
+            .variables = std::make_shared<const std::vector<std::string>>(
+                    std::vector<std::string>{"GREETING={{greeting}}", "PATH=/usr/bin"}),
+            .parametrizedVariables = {{0, "GREETING={{greeting}} from the long environment variable"}}};
+    processCfg.placement = std::make_shared<const stone_skipper::ProcessPlacement>(
+            stone_skipper::ProcessPlacement{.cpuAffinity = {0}, .niceIncrement = 5});
+    return processCfg;
+}
+
+} //namespace
+
+void* operator new(std::size_t size)
+{
+    if (isAllocationCountingEnabled)
+        ++allocationsNumber;
+    if (auto ptr = std::malloc(size))
+        return ptr;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+TEST(ProcessCfg, MakeProcessCfg)
+{
+    const auto templateProcessCfg = makeTemplateProcessCfg();
+    const auto processCfg = stone_skipper::makeProcessCfg(templateProcessCfg, testParamValue);
+    ASSERT_EQ(processCfg.command, "echo \"Hello world\" && echo {{unknown_param_is_kept}}");
+    ASSERT_EQ(processCfg.shellCommand, templateProcessCfg.shellCommand);
+    ASSERT_EQ(processCfg.workingDir, templateProcessCfg.workingDir);
+    ASSERT_EQ(processCfg.placement, templateProcessCfg.placement);
+    ASSERT_TRUE(processCfg.environment.has_value());
+    ASSERT_EQ(processCfg.environment->variables, templateProcessCfg.environment->variables);
+    ASSERT_EQ(processCfg.environment->block, templateProcessCfg.environment->block);
+    ASSERT_EQ(
+            processCfg.environment->parametrizedVariables,
+            (std::vector<std::pair<std::size_t, std::string>>{
+                    {0, "GREETING=Hello from the long environment variable"}}));
+}
+
+TEST(ProcessCfg, MakeProcessCfgDoesntExpandParamValues)
+{
+    auto templateProcessCfg = stone_skipper::ProcessCfg{};
+    templateProcessCfg.command = "echo {{name}} {{greeting}}";
+    templateProcessCfg.params = {"name", "greeting"};
+    const auto processCfg = stone_skipper::makeProcessCfg(
+            templateProcessCfg,
+            [](std::string_view param) -> std::optional<std::string_view>
+            {
+                if (param == "name")
+                    return "{{greeting}}";
+                return "Hello";
+            });
+    ASSERT_EQ(processCfg.command, "echo {{greeting}} Hello");
+}
+
+TEST(ProcessCfg, MakeProcessCfgMissingParam)
+{
+    auto templateProcessCfg = stone_skipper::ProcessCfg{};
+    templateProcessCfg.command = "echo {{foo}}";
+    templateProcessCfg.params = {"foo"};
+    assert_exception<stone_skipper::ProcessCfgParametrizationError>(
+            [&]
+            {
+                [[maybe_unused]] auto processCfg = stone_skipper::makeProcessCfg(templateProcessCfg, testParamValue);
+            },
+            [](const auto& e)
+            {
+                ASSERT_EQ(
+                        e.message("echo {{foo}}"),
+                        "Couldn't launch the command 'echo {{foo}}'. Request doesn't contain a parameter 'foo'");
+            });
+}
+
+TEST(ProcessCfg, MakeProcessCfgMissingParamInEnvironment)
+{
+    auto templateProcessCfg = stone_skipper::ProcessCfg{};
+    templateProcessCfg.command = "echo $FOO";
+    templateProcessCfg.params = {"foo"};
+    templateProcessCfg.environment = stone_skipper::ProcessEnvironment{
+            .variables = std::make_shared<const std::vector<std::string>>(std::vector<std::string>{"FOO={{foo}}"}),
+            .parametrizedVariables = {{0, "FOO={{foo}}"}}};
+    assert_exception<stone_skipper::ProcessCfgParametrizationError>(
+            [&]
+            {
+                [[maybe_unused]] auto processCfg = stone_skipper::makeProcessCfg(templateProcessCfg, testParamValue);
+            },
+            [](const auto& e)
+            {
+                ASSERT_EQ(
+                        e.message("echo $FOO"),
+                        "Couldn't launch the command 'echo $FOO'. Request doesn't contain a parameter 'foo'");
+            });
+}
+
+TEST(ProcessCfg, MakeProcessCfgAllocationsNumber)
+{
+    const auto templateProcessCfg = makeTemplateProcessCfg();
+    auto allocationCounter = AllocationCounter{};
+    [[maybe_unused]] const auto processCfg = stone_skipper::makeProcessCfg(templateProcessCfg, testParamValue);
+    // command, working directory, parametrized environment variables list and its single item
+    ASSERT_LE(allocationCounter.count(), 4);
+}
@@ -0,0 +1,198 @@
+#include "allocation_counter.h"
+#include <processlauncher.h>
+#include <shellpool.h>
+#include <gtest/gtest.h>
+#include <boost/asio.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+stone_skipper::ProcessCfg makeTemplateProcessCfg(const std::string& command = "echo \"Hello {{name}}\"")
+{
+    auto processCfg = stone_skipper::ProcessCfg{};
+    processCfg.command = command;
+    processCfg.params = {"name"};
+    processCfg.shellCommand =
+            std::make_shared<const std::vector<std::string>>(std::vector<std::string>{"sh", "-c"});
+    return processCfg;
+}
+
+stone_skipper::ProcessResult launch(boost::asio::io_context& io, const stone_skipper::ProcessCfg& templateProcessCfg)
+{
+    auto result = std::optional<stone_skipper::ProcessResult>{};
+    boost::asio::co_spawn(
+            io,
+            [&]() -> boost::asio::awaitable<void>
+            {
+                const auto processCfg = stone_skipper::makeProcessCfg(
+                        templateProcessCfg,
+                        [](std::string_view) -> std::optional<std::string_view>
+                        {
+                            return "world";
+                        });
+                result = co_await stone_skipper::asyncLaunchProcess(io, processCfg);
+            },
+            boost::asio::detached);
+    while (!result.has_value())
+        io.run_one();
+    return std::move(result.value());
+}
+
+} //namespace
+
+#ifndef _WIN32
+TEST(ProcessLauncher, LaunchProcess)
+{
+    auto io = boost::asio::io_context{};
+    const auto result = launch(io, makeTemplateProcessCfg());
+    ASSERT_EQ(result.exitCode, 0);
+    ASSERT_EQ(result.output, "Hello world\n");
+    ASSERT_TRUE(result.resourceUsage.has_value());
+}
+
+TEST(ProcessLauncher, LaunchProcessWithParametrizedEnvironment)
+{
+    auto io = boost::asio::io_context{};
+    auto templateProcessCfg = makeTemplateProcessCfg("echo \"$GREETING\"");
+    templateProcessCfg.environment =
+            stone_skipper::makeProcessEnvironment({{"GREETING", "Hello {{name}}, {{unknown}}"}}, false);
+    const auto result = launch(io, templateProcessCfg);
+    ASSERT_EQ(result.exitCode, 0);
+    ASSERT_EQ(result.output, "Hello world, {{unknown}}\n");
+}
+
+TEST(ProcessLauncher, LaunchProcessWithEnvironment)
+{
+    auto io = boost::asio::io_context{};
+    auto templateProcessCfg = makeTemplateProcessCfg("echo \"$GREETING\"");
+    templateProcessCfg.environment = stone_skipper::makeProcessEnvironment({{"GREETING", "Hello"}}, true);
+    const auto& environment = templateProcessCfg.environment.value();
+    ASSERT_TRUE(environment.parametrizedVariables.empty());
+    ASSERT_EQ(*environment.variables, (std::vector<std::string>{"GREETING=Hello"}));
+    ASSERT_EQ(environment.block->size(), 2);
+    ASSERT_EQ(environment.block->front(), environment.variables->front().c_str());
+    ASSERT_EQ(environment.block->back(), nullptr);
+    const auto result = launch(io, templateProcessCfg);
+    ASSERT_EQ(result.exitCode, 0);
+    ASSERT_EQ(result.output, "Hello\n");
+}
+
+TEST(ProcessLauncher, LaunchProcessWithInheritedEnvironment)
+{
+    setenv("STONE_SKIPPER_TEST_INHERITED", "inherited", 1);
+    setenv("STONE_SKIPPER_TEST_OVERRIDDEN", "inherited", 1);
+    auto io = boost::asio::io_context{};
+    auto templateProcessCfg =
+            makeTemplateProcessCfg("echo \"$STONE_SKIPPER_TEST_INHERITED $STONE_SKIPPER_TEST_OVERRIDDEN\"");
+    templateProcessCfg.environment =
+            stone_skipper::makeProcessEnvironment({{"STONE_SKIPPER_TEST_OVERRIDDEN", "{{name}}"}}, false);
+    const auto result = launch(io, templateProcessCfg);
+    ASSERT_EQ(result.exitCode, 0);
+    ASSERT_EQ(result.output, "inherited world\n");
+}
+
+TEST(ProcessLauncher, LaunchProcessWithClearedEnvironment)
+{
+    setenv("STONE_SKIPPER_TEST_INHERITED", "inherited", 1);
+    auto io = boost::asio::io_context{};
+    auto templateProcessCfg =
+            makeTemplateProcessCfg("echo \"[$STONE_SKIPPER_TEST_INHERITED] $STONE_SKIPPER_TEST_OWN\"");
+    templateProcessCfg.environment =
+            stone_skipper::makeProcessEnvironment({{"STONE_SKIPPER_TEST_OWN", "{{name}}"}}, true);
+    const auto result = launch(io, templateProcessCfg);
+    ASSERT_EQ(result.exitCode, 0);
+    ASSERT_EQ(result.output, "[] world\n");
+}
+
+TEST(ProcessLauncher, LaunchProcessesFromSeveralIoContexts)
+{
+    using namespace std::chrono_literals;
+    const auto processCfg = makeTemplateProcessCfg("true");
+    const auto launchesNumber = 100;
+    auto finishedLaunchesNumbers = std::array<std::atomic<int>, 2>{};
+    auto ioThreads = std::vector<std::jthread>{};
+    for (auto& finishedLaunchesNumber : finishedLaunchesNumbers)
+        ioThreads.emplace_back(
+                [&]
+                {
+                    auto io = boost::asio::io_context{};
+                    for (auto i = 0; i < launchesNumber; ++i)
+                        boost::asio::co_spawn(
+                                io,
+                                [&]() -> boost::asio::awaitable<void>
+                                {
+                                    const auto result = co_await stone_skipper::asyncLaunchProcess(io, processCfg);
+                                    if (result.exitCode == 0)
+                                        ++finishedLaunchesNumber;
+                                },
+                                boost::asio::detached);
+                    const auto deadline = std::chrono::steady_clock::now() + 10s;
+                    while (finishedLaunchesNumber < launchesNumber && std::chrono::steady_clock::now() < deadline)
+                        io.run_one_for(100ms);
+                });
+    ioThreads.clear();
+
+    for (const auto& finishedLaunchesNumber : finishedLaunchesNumbers)
+        ASSERT_EQ(finishedLaunchesNumber, launchesNumber);
+}
+
+TEST(ProcessLauncher, LaunchProcessWithExitedPooledShells)
+{
+    using namespace std::chrono_literals;
+    auto io = boost::asio::io_context{};
+    auto shellPool = stone_skipper::ShellPool{{"sh", "-c", "kill -9 $$"}, 2};
+    const auto templateProcessCfg = makeTemplateProcessCfg();
+    for (auto i = 0; i < 5; ++i) {
+        auto result = std::optional<stone_skipper::ProcessResult>{};
+        boost::asio::co_spawn(
+                io,
+                [&]() -> boost::asio::awaitable<void>
+                {
+                    result = co_await stone_skipper::asyncLaunchProcess(io, templateProcessCfg, {}, &shellPool);
+                },
+                boost::asio::detached);
+        while (!result.has_value())
+            io.run_one();
+        ASSERT_EQ(result->exitCode, 0);
+        ASSERT_EQ(result->output, "Hello {{name}}\n");
+        std::this_thread::sleep_for(300ms);
+    }
+}
+
+TEST(ProcessLauncher, LaunchPathAllocationsNumber)
+{
+    auto io = boost::asio::io_context{};
+    const auto templateProcessCfg = makeTemplateProcessCfg();
+    launch(io, templateProcessCfg);
+
+    auto allocationCounter = AllocationCounter{};
+    const auto result = launch(io, templateProcessCfg);
+    const auto allocationsNumber = allocationCounter.count();
+    ASSERT_EQ(result.output, "Hello world\n");
+    // request's ProcessCfg, coroutine frames, Process with its pipes, spawn arguments, output chunks and result
+    ASSERT_LE(allocationsNumber, 50) << allocationsNumber;
+}
+
+TEST(ProcessLauncher, LargeOutputAllocationsNumber)
+{
+    auto io = boost::asio::io_context{};
+    const auto templateProcessCfg = makeTemplateProcessCfg("head -c 4194304 /dev/zero");
+
+    auto allocationCounter = AllocationCounter{};
+    const auto result = launch(io, templateProcessCfg);
+    const auto allocationsNumber = allocationCounter.count();
+    ASSERT_EQ(result.output.size(), 4194304);
+    // output is coalesced into chunk buffers and the launcher is resumed only when the process finishes,
+    // so the allocations number doesn't grow with the number of 4 KB reads
+    ASSERT_LE(allocationsNumber, 256) << allocationsNumber;
+}
+#endif
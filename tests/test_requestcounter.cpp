@@ -0,0 +1,28 @@
+#include <requestcounter.h>
+#include <gtest/gtest.h>
+
+TEST(RequestCounter, CountsActiveRequests)
+{
+    auto counter = stone_skipper::RequestCounter{};
+    auto request = counter.startRequest();
+    auto requestCopy = request;
+    auto otherRequest = counter.startRequest();
+    ASSERT_EQ(counter.activeRequestsNumber(), 2);
+    request.reset();
+    ASSERT_EQ(counter.activeRequestsNumber(), 2);
+    requestCopy.reset();
+    ASSERT_EQ(counter.activeRequestsNumber(), 1);
+    otherRequest.reset();
+    ASSERT_EQ(counter.activeRequestsNumber(), 0);
+}
+
+TEST(RequestCounter, StopAcceptingRequests)
+{
+    auto counter = stone_skipper::RequestCounter{};
+    auto request = counter.startRequest();
+    counter.stopAcceptingRequests();
+    ASSERT_EQ(counter.startRequest(), nullptr);
+    ASSERT_EQ(counter.activeRequestsNumber(), 1);
+    request.reset();
+    ASSERT_EQ(counter.activeRequestsNumber(), 0);
+}
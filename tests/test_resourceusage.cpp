@@ -0,0 +1,46 @@
+#include <resourceusage.h>
+#include <gtest/gtest.h>
+
+TEST(ResourceUsage, Description)
+{
+    const auto usage = stone_skipper::ResourceUsage{
+            .userCpuTime = 0.25,
+            .systemCpuTime = 0.0625,
+            .maxResidentSetSize = 2048,
+            .blockInputOperations = 1,
+            .blockOutputOperations = 8,
+            .voluntaryContextSwitches = 3,
+            .involuntaryContextSwitches = 2};
+    ASSERT_EQ(
+            stone_skipper::resourceUsageDescription(usage),
+            "CPU time: user 0.250s, system 0.062s, max RSS: 2048 KB, block IO: 1 in, 8 out, "
+            "context switches: 3 voluntary, 2 involuntary");
+}
+
+TEST(ResourceUsage, Stats)
+{
+    auto stats = stone_skipper::ResourceUsageStats{};
+    stats.add({.userCpuTime = 1,
+               .systemCpuTime = 0.5,
+               .maxResidentSetSize = 1024,
+               .blockInputOperations = 1,
+               .blockOutputOperations = 2,
+               .voluntaryContextSwitches = 3,
+               .involuntaryContextSwitches = 4});
+    stats.add({.userCpuTime = 2,
+               .systemCpuTime = 0.25,
+               .maxResidentSetSize = 512,
+               .blockInputOperations = 10,
+               .blockOutputOperations = 20,
+               .voluntaryContextSwitches = 30,
+               .involuntaryContextSwitches = 40});
+    ASSERT_EQ(stats.processesNumber(), 2);
+    const auto total = stats.total();
+    ASSERT_DOUBLE_EQ(total.userCpuTime, 3);
+    ASSERT_DOUBLE_EQ(total.systemCpuTime, 0.75);
+    ASSERT_EQ(total.maxResidentSetSize, 1024);
+    ASSERT_EQ(total.blockInputOperations, 11);
+    ASSERT_EQ(total.blockOutputOperations, 22);
+    ASSERT_EQ(total.voluntaryContextSwitches, 33);
+    ASSERT_EQ(total.involuntaryContextSwitches, 44);
+}
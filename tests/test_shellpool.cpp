@@ -0,0 +1,149 @@
+#include <childreaper.h>
+#include <shellpool.h>
+#include <gtest/gtest.h>
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <boost/asio.hpp>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <optional>
+#include <string>
+#include <thread>
+
+namespace {
+
+class ShellPoolTest : public ::testing::Test {
+protected:
+    void TearDown() override
+    {
+        workGuard_.reset();
+        io_.stop();
+        // shells retired by the pool's destructor can exit after the io_context has stopped
+        while (wait(nullptr) > 0) {
+        }
+    }
+
+    template<typename TPredicate>
+    bool waitUntil(const TPredicate& predicate)
+    {
+        using namespace std::chrono_literals;
+        const auto deadline = std::chrono::steady_clock::now() + 5s;
+        while (!predicate()) {
+            if (std::chrono::steady_clock::now() >= deadline)
+                return false;
+            std::this_thread::sleep_for(50ms);
+        }
+        return true;
+    }
+
+    std::optional<stone_skipper::PooledShell> acquireShell(
+            stone_skipper::ShellPool& shellPool,
+            const std::string& command,
+            const std::string& workingDir)
+    {
+        auto shell = std::optional<stone_skipper::PooledShell>{};
+        waitUntil(
+                [&]
+                {
+                    shell = shellPool.acquire(io_, command, workingDir);
+                    return shell.has_value();
+                });
+        return shell;
+    }
+
+    bool hasZombieChildren()
+    {
+        auto childInfo = siginfo_t{};
+        return waitid(P_ALL, 0, &childInfo, WEXITED | WNOHANG | WNOWAIT) == 0 && childInfo.si_pid != 0;
+    }
+
+    boost::asio::io_context io_;
+    std::optional<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> workGuard_ =
+            boost::asio::make_work_guard(io_);
+    std::jthread ioThread_{[this]
+                           {
+                               io_.run();
+                           }};
+};
+
+} //namespace
+
+TEST_F(ShellPoolTest, AcquiredShellRunsCommand)
+{
+    auto shellPool = stone_skipper::ShellPool{{"sh", "-c"}, 2};
+    auto shell = acquireShell(shellPool, "pwd && exit 3", "/");
+    ASSERT_TRUE(shell.has_value());
+
+    auto exitCode = std::promise<int>{};
+    boost::asio::use_service<stone_skipper::ChildReaper>(io_).watch(
+            shell->pid,
+            [&](int status, const stone_skipper::ResourceUsage&)
+            {
+                exitCode.set_value(WEXITSTATUS(status));
+            });
+    auto output = std::string{};
+    auto error = boost::system::error_code{};
+    boost::asio::read(*shell->output, boost::asio::dynamic_buffer(output), error);
+    ASSERT_EQ(output, "/\n");
+    ASSERT_EQ(exitCode.get_future().get(), 3);
+}
+
+TEST_F(ShellPoolTest, IdleShellsAreRetiredWithoutDemand)
+{
+    auto shellPool = stone_skipper::ShellPool{{"sh", "-c"}, 2};
+    ASSERT_FALSE(shellPool.acquire(io_, "true", "/").has_value());
+    ASSERT_TRUE(waitUntil(
+            [&]
+            {
+                return shellPool.idleShellsNumber(io_) == 1;
+            }));
+    ASSERT_TRUE(waitUntil(
+            [&]
+            {
+                return shellPool.idleShellsNumber(io_) == 0;
+            }));
+    ASSERT_TRUE(waitUntil(
+            [&]
+            {
+                return !hasZombieChildren();
+            }));
+}
+
+TEST_F(ShellPoolTest, ExitedShellsAreNotAcquired)
+{
+    using namespace std::chrono_literals;
+    auto shellPool = stone_skipper::ShellPool{{"sh", "-c", "kill -9 $$"}, 2};
+    for (auto i = 0; i < 5; ++i) {
+        ASSERT_FALSE(shellPool.acquire(io_, "true", "/").has_value());
+        std::this_thread::sleep_for(300ms);
+    }
+    ASSERT_TRUE(waitUntil(
+            [&]
+            {
+                return !hasZombieChildren();
+            }));
+}
+
+TEST_F(ShellPoolTest, IdleShellsNumberIsLimitedAcrossIoContexts)
+{
+    using namespace std::chrono_literals;
+    auto otherIo = boost::asio::io_context{};
+    auto shellPool = stone_skipper::ShellPool{{"sh", "-c"}, 2};
+    for (auto i = 0; i < 2; ++i) {
+        shellPool.acquire(io_, "true", "/");
+        shellPool.acquire(otherIo, "true", "/");
+    }
+    const auto idleShellsNumber = [&]
+    {
+        return shellPool.idleShellsNumber(io_) + shellPool.idleShellsNumber(otherIo);
+    };
+    ASSERT_TRUE(waitUntil(
+            [&]
+            {
+                return idleShellsNumber() == 2;
+            }));
+    std::this_thread::sleep_for(300ms);
+    ASSERT_EQ(idleShellsNumber(), 2);
+}
+#endif
@@ -0,0 +1,94 @@
+#include <taskscheduler.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+TEST(TaskScheduler, UnlimitedLaunchesImmediately)
+{
+    auto scheduler = stone_skipper::TaskScheduler{0, {}};
+    auto launched = std::vector<std::string>{};
+    scheduler.schedule(
+            "batch",
+            [&]
+            {
+                launched.emplace_back("b1");
+            });
+    scheduler.schedule(
+            "interactive",
+            [&]
+            {
+                launched.emplace_back("i1");
+            });
+    ASSERT_EQ(launched, (std::vector<std::string>{"b1", "i1"}));
+}
+
+TEST(TaskScheduler, WeightedFairAdmission)
+{
+    auto scheduler = stone_skipper::TaskScheduler{1, {{"interactive", 2}, {"batch", 1}}};
+    auto launched = std::vector<std::string>{};
+    auto schedule = [&](const std::string& priorityClass, const std::string& name)
+    {
+        scheduler.schedule(
+                priorityClass,
+                [&launched, name]
+                {
+                    launched.push_back(name);
+                });
+    };
+    schedule("batch", "b0");
+    schedule("batch", "b1");
+    schedule("batch", "b2");
+    schedule("interactive", "i1");
+    schedule("interactive", "i2");
+    schedule("interactive", "i3");
+    ASSERT_EQ(launched, (std::vector<std::string>{"b0"}));
+
+    for (auto i = 0; i < 5; ++i)
+        scheduler.onTaskFinished();
+    ASSERT_EQ(launched, (std::vector<std::string>{"b0", "i1", "i2", "b1", "i3", "b2"}));
+
+    scheduler.onTaskFinished();
+    schedule("batch", "b3");
+    ASSERT_EQ(launched.back(), "b3");
+}
+
+TEST(TaskScheduler, IdleClassDoesNotAccumulateCredit)
+{
+    auto scheduler = stone_skipper::TaskScheduler{2, {{"interactive", 2}, {"batch", 1}}};
+    auto launched = std::vector<std::string>{};
+    auto schedule = [&](const std::string& priorityClass, const std::string& name)
+    {
+        scheduler.schedule(
+                priorityClass,
+                [&launched, name]
+                {
+                    launched.push_back(name);
+                });
+    };
+    for (auto i = 0; i < 20; ++i) {
+        schedule("interactive", "i");
+        scheduler.onTaskFinished();
+    }
+    launched.clear();
+
+    schedule("interactive", "i1");
+    schedule("batch", "b0");
+    for (const auto& name : {"b1", "b2", "b3", "b4"})
+        schedule("batch", name);
+    for (const auto& name : {"i2", "i3", "i4"})
+        schedule("interactive", name);
+    ASSERT_EQ(launched, (std::vector<std::string>{"i1", "b0"}));
+
+    for (auto i = 0; i < 7; ++i)
+        scheduler.onTaskFinished();
+    ASSERT_EQ(launched, (std::vector<std::string>{"i1", "b0", "i2", "b1", "i3", "i4", "b2", "b3", "b4"}));
+}
+
+TEST(TaskScheduler, DefaultPriorityClasses)
+{
+    auto scheduler = stone_skipper::TaskScheduler{0, {{"health", 16}}};
+    ASSERT_TRUE(scheduler.hasPriorityClass("health"));
+    ASSERT_TRUE(scheduler.hasPriorityClass("interactive"));
+    ASSERT_TRUE(scheduler.hasPriorityClass("batch"));
+    ASSERT_FALSE(scheduler.hasPriorityClass("unknown"));
+}
@@ -0,0 +1,51 @@
+#include <tracer.h>
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string readFile(const fs::path& path)
+{
+    auto stream = std::ifstream{path};
+    auto buffer = std::stringstream{};
+    buffer << stream.rdbuf();
+    return buffer.str();
+}
+
+} //namespace
+
+TEST(Tracer, RecordEvents)
+{
+    const auto traceFilePath = fs::temp_directory_path() / "stone_skipper_test_trace.json";
+    {
+        auto tracer = stone_skipper::Tracer{traceFilePath, 1.0, 1024 * 1024};
+        const auto trace = tracer.startRequestTrace();
+        ASSERT_TRUE(trace);
+        trace.record("launchProcess", trace.now());
+        trace.batchItemTrace(1).record("sendResponse", trace.now());
+    }
+    const auto traceFileContent = readFile(traceFilePath);
+    EXPECT_NE(traceFileContent.find(R"("name":"launchProcess")"), std::string::npos);
+    EXPECT_NE(traceFileContent.find(R"("args":{"request":1,"batchItem":1})"), std::string::npos);
+    fs::remove(traceFilePath);
+}
+
+TEST(Tracer, RecordEventsOfTracerRecreatedAtSameAddress)
+{
+    const auto traceFilePath = fs::temp_directory_path() / "stone_skipper_test_trace.json";
+    auto tracer = std::optional<stone_skipper::Tracer>{};
+    for (const auto eventName : {"firstTracerEvent", "secondTracerEvent"}) {
+        tracer.emplace(traceFilePath, 1.0, 1024 * 1024);
+        const auto trace = tracer->startRequestTrace();
+        trace.record(eventName, trace.now());
+        tracer.reset();
+        EXPECT_NE(readFile(traceFilePath).find(eventName), std::string::npos);
+    }
+    fs::remove(traceFilePath);
+}
@@ -4,6 +4,10 @@
 #include <gtest/gtest.h>
 #include <functional>
 
+namespace {
+const auto maxCpuIndex = 1023;
+}
+
 TEST(Utils, SplitCommand)
 {
     auto parts = stone_skipper::splitCommand("command -param \"hello world\"");
@@ -97,3 +101,72 @@ TEST(Utils, SplitCommandUnclosedString2)
                 ASSERT_EQ(std::string{e.what()}, "Command 'command -param \"' has an unclosed quotation mark");
             });
 }
+
+TEST(Utils, ParseCpuList)
+{
+    ASSERT_EQ(stone_skipper::parseCpuList("1022-1023", maxCpuIndex), (std::vector<int>{1022, 1023}));
+    ASSERT_EQ(stone_skipper::parseCpuList("0", maxCpuIndex), (std::vector<int>{0}));
+    ASSERT_EQ(stone_skipper::parseCpuList("0-3,6", maxCpuIndex), (std::vector<int>{0, 1, 2, 3, 6}));
+    ASSERT_EQ(stone_skipper::parseCpuList("6,2-3,3", maxCpuIndex), (std::vector<int>{2, 3, 6}));
+}
+
+TEST(Utils, ParseCpuListInvalidItem)
+{
+    assert_exception<stone_skipper::Error>(
+            []
+            {
+                [[maybe_unused]] auto cpus = stone_skipper::parseCpuList("0-3,a", maxCpuIndex);
+            },
+            [](const auto& e)
+            {
+                ASSERT_EQ(std::string{e.what()}, "CPU list '0-3,a' has an invalid item 'a'");
+            });
+}
+
+TEST(Utils, ParseCpuListInvalidRange)
+{
+    assert_exception<stone_skipper::Error>(
+            []
+            {
+                [[maybe_unused]] auto cpus = stone_skipper::parseCpuList("3-1", maxCpuIndex);
+            },
+            [](const auto& e)
+            {
+                ASSERT_EQ(std::string{e.what()}, "CPU list '3-1' has an invalid item '3-1'");
+            });
+}
+
+TEST(Utils, ParseCpuListIndexAboveMax)
+{
+    assert_exception<stone_skipper::Error>(
+            []
+            {
+                [[maybe_unused]] auto cpus = stone_skipper::parseCpuList("0-2147483647", maxCpuIndex);
+            },
+            [](const auto& e)
+            {
+                ASSERT_EQ(std::string{e.what()}, "CPU list '0-2147483647' contains a CPU index above 1023");
+            });
+    assert_exception<stone_skipper::Error>(
+            []
+            {
+                [[maybe_unused]] auto cpus = stone_skipper::parseCpuList("1,1024", maxCpuIndex);
+            },
+            [](const auto& e)
+            {
+                ASSERT_EQ(std::string{e.what()}, "CPU list '1,1024' contains a CPU index above 1023");
+            });
+}
+
+TEST(Utils, ParseCpuListEmptyItem)
+{
+    assert_exception<stone_skipper::Error>(
+            []
+            {
+                [[maybe_unused]] auto cpus = stone_skipper::parseCpuList("1,,2", maxCpuIndex);
+            },
+            [](const auto& e)
+            {
+                ASSERT_EQ(std::string{e.what()}, "CPU list '1,,2' has an invalid item ''");
+            });
+}